@@ -0,0 +1,254 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Adaptive batching of the ADO writes of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Per ADO batches, AIMD size and delay, RTT EWMA.
+ * version v02 2026-10-19. Typed items.
+ * version v03 2026-10-19. Array items.
+ * version v04 2026-10-19. Tracepoints around the Set.
+ * version v05 2026-10-19. Warm cache recorded after the Set.
+ * version v06 2026-10-19. Delta copies dropped after a failed write.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epicsTime.h>
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "reactor.h"
+#include "ado_batch.h"
+#include "warm.h"
+#include "delta.h"
+#include "probes.h"
+
+#define BATCH_DELAY_QUANTUM 1e-4    /* Delays below it are set to the minimum, s */
+#define BATCH_ARENA_SIZE 4096       /* Initial size of the value storage */
+
+/* Batch of one ADO */
+typedef struct adoBatch
+{
+    char  *adoName;
+    int    n;                       // updates in the batch
+    int    size;                    // current batch size
+    int    minSize, maxSize;
+    double delay;                   // current flush delay, s
+    double minDelay, maxDelay;
+    double srtt;                    // smoothed round trip of the setter, s
+    double tFirst;                  // arrival of the first update of the batch
+    int    timer;                   // flush timer, -1: not created yet
+    adoItem *items;                 // maxSize entries
+    size_t *valOffs;                // offsets of the string and array values in the arena
+    char  *arena;                   // copies of the string and array values
+    size_t arenaLen, arenaSize;
+    unsigned long batches;          // number of setter calls
+    unsigned long writes;           // number of updates written
+    unsigned long failed;           // number of failed updates
+} adoBatch;
+
+static adoBatch gDefault = {NULL, 0, BATCH_MIN_SIZE, BATCH_MIN_SIZE, BATCH_MAX_SIZE,
+                            BATCH_MIN_DELAY, BATCH_MIN_DELAY, BATCH_MAX_DELAY};
+static adoBatch gBatches[BATCH_MAX_ADOS];
+static int gNBatches = 0;
+
+/* batch_of - batch of the ADO, created with the default bounds */
+static adoBatch *batch_of (const char *adoName, size_t len)
+{
+    adoBatch *b;
+    int ii;
+
+    for (ii = 0; ii < gNBatches; ii++)
+        if (strncmp(gBatches[ii].adoName, adoName, len) == 0 && gBatches[ii].adoName[len] == '\0')
+            return &gBatches[ii];
+    if (gNBatches >= BATCH_MAX_ADOS) {
+        fprintf(stderr, "Too many ADOs, max %i\n", BATCH_MAX_ADOS);
+        return NULL;
+    }
+    b = &gBatches[gNBatches];
+    *b = gDefault;
+    b->adoName = malloc(len + 1);
+    if (!b->adoName) return NULL;
+    memcpy(b->adoName, adoName, len);
+    b->adoName[len] = '\0';
+    b->timer = -1;
+    gNBatches++;
+    return b;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	batch_config
+ *
+ * Description:	Set the bounds of the batch size and of the flush delay
+ *
+ * Arg(s) In:	spec  -  [<ado>=]<min>:<max>[,<dmin>:<dmax>], sizes in updates,
+ *                       delays in seconds; without <ado> sets the default
+ *
+ * Return(s):	0 - success, 1 - invalid spec
+ *
+ **************************************************************************-*/
+
+int batch_config (const char *spec)
+{
+    const char *eq = strchr(spec, '=');
+    adoBatch *b = eq ? batch_of(spec, eq - spec) : &gDefault;
+    int minSize, maxSize, n;
+    double minDelay, maxDelay;
+
+    if (!b) return 1;
+    minDelay = b->minDelay;
+    maxDelay = b->maxDelay;
+    n = sscanf(eq ? eq + 1 : spec, "%i:%i,%lf:%lf", &minSize, &maxSize, &minDelay, &maxDelay);
+    if ((n != 2 && n != 4) || minSize < 1 || maxSize < minSize
+        || minDelay < 0. || maxDelay < minDelay)
+        return 1;
+    b->minSize = b->size = minSize;
+    b->maxSize = maxSize;
+    b->minDelay = b->delay = minDelay;
+    b->maxDelay = maxDelay;
+    return 0;
+}
+
+/* batch_flush - one setter call for the collected updates, then adapt */
+static void batch_flush (adoBatch *b)
+{
+    int ii, full = b->n >= b->size, failed;
+    double t0, rtt;
+
+    for (ii = 0; ii < b->n; ii++)
+    {
+        adoItem *it = &b->items[ii];
+        if (it->count > 1)                   it->vec = (double *)(b->arena + b->valOffs[ii]);
+        else if (it->type == adoTypeString) it->str = b->arena + b->valOffs[ii];
+    }
+    t0 = sched_now();
+    E2A_PROBE3(set_begin, b->adoName, b->n, 0);
+    failed = gAdoSetBatch(b->adoName, b->n, b->items);
+    E2A_PROBE3(set_end, b->adoName, b->n, failed);
+    rtt = sched_now() - t0;
+    warm_written(b->n, b->items, failed);
+    delta_written(b->n, b->items, failed);
+    b->failed += failed;
+    b->srtt = b->batches ? b->srtt + BATCH_RTT_GAIN*(rtt - b->srtt) : rtt;
+    b->batches++;
+    b->writes += b->n;
+    b->n = 0;
+    b->arenaLen = 0;
+
+    if (full)                           /* falling behind: additive increase */
+    {
+        if (b->size < b->maxSize) b->size++;
+        b->delay = b->srtt < b->minDelay ? b->minDelay
+                 : b->srtt > b->maxDelay ? b->maxDelay : b->srtt;
+    }
+    else if (!sched_pending())          /* light load: multiplicative decrease */
+    {
+        b->size = b->size/2 < b->minSize ? b->minSize : b->size/2;
+        b->delay = b->delay/2 < b->minDelay + BATCH_DELAY_QUANTUM ? b->minDelay : b->delay/2;
+    }
+    if (gVerb&VERB_DETAILED) printf("ADO %s: batch of %i in %.6f s, next size %i, delay %.6f s\n",
+                                    b->adoName, ii, rtt, b->size, b->delay);
+}
+
+/* Flush timer: flush the batch if its delay expired, otherwise re-arm */
+static void batch_timer (void *arg, int fd)
+{
+    adoBatch *b = arg;
+    double left;
+
+    if (!b->n) return;
+    left = b->tFirst + b->delay - sched_now();
+    if (left > 0.) reactor_set_timer(b->timer, left, 0.);
+    else           batch_flush(b);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	batch_add
+ *
+ * Description:	Add the update to the batch of the ADO, flush if it is full
+ *
+ * Arg(s) In:	adoName  -  ADO name
+ *              item     -  The write, the parameter name must stay valid
+ *                          until the flush, string and array values are copied
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int batch_add (const char *adoName, const adoItem *item)
+{
+    adoBatch *b = batch_of(adoName, strlen(adoName));
+
+    if (!b) return 1;
+    if (!b->items)                      /* first update of the ADO */
+    {
+        b->items = malloc(b->maxSize*sizeof(adoItem));
+        b->valOffs = malloc(b->maxSize*sizeof(size_t));
+        if (!b->items || !b->valOffs) return 1;
+    }
+    if (item->count > 1 || item->type == adoTypeString)
+    {
+        size_t off = (b->arenaLen + sizeof(double) - 1) & ~(sizeof(double) - 1);
+        size_t len = item->count > 1 ? item->count*sizeof(double) : strlen(item->str) + 1;
+        if (off + len > b->arenaSize)
+        {
+            size_t size = b->arenaSize ? 2*b->arenaSize : BATCH_ARENA_SIZE;
+            char *p;
+            while (size < off + len) size *= 2;
+            p = realloc(b->arena, size);
+            if (!p) return 1;
+            b->arena = p;
+            b->arenaSize = size;
+        }
+        memcpy(b->arena + off, item->count > 1 ? (const void *)item->vec : item->str, len);
+        b->valOffs[b->n] = off;
+        b->arenaLen = off + len;
+    }
+    b->items[b->n] = *item;
+    if (b->n++ == 0)
+    {
+        b->tFirst = sched_now();
+        if (b->delay > 0.)
+        {
+            if (b->timer < 0) b->timer = reactor_add_timer(0., 0., batch_timer, b);
+            if (b->timer >= 0) reactor_set_timer(b->timer, b->delay, 0.);
+        }
+    }
+    if (b->n >= b->size) batch_flush(b);
+    return 0;
+}
+
+// batch_flush_due - called at the end of the loop iteration:
+// flush the batches without delay and those whose delay expired
+void batch_flush_due (void)
+{
+    double now = 0.;
+    int ii;
+
+    for (ii = 0; ii < gNBatches; ii++)
+    {
+        adoBatch *b = &gBatches[ii];
+        if (!b->n) continue;
+        if (b->delay > 0.) {
+            if (now == 0.) now = sched_now();
+            if (now - b->tFirst < b->delay && b->timer >= 0) continue;
+        }
+        batch_flush(b);
+    }
+}
+
+void batch_report (FILE *stream)
+{
+    int ii;
+    for (ii = 0; ii < gNBatches; ii++)
+    {
+        adoBatch *b = &gBatches[ii];
+        fprintf(stream, "ado %s: batches %lu, writes %lu, failed %lu, size %i (%i-%i), "
+                "delay %.6f s (%g-%g), rtt %.6f s\n",
+                b->adoName, b->batches, b->writes, b->failed, b->size, b->minSize, b->maxSize,
+                b->delay, b->minDelay, b->maxDelay, b->srtt);
+    }
+}
@@ -0,0 +1,33 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Adaptive batching of the ADO writes of the epics to ado bridge
+ *
+ * The updates forwarded by the scheduler are collected per ADO and sent with
+ * one call of the ADO setter. A batch is flushed when it reaches the batch
+ * size, when its first update has waited for the flush delay, or, with zero
+ * delay, at the end of the loop iteration. Size and delay adapt AIMD-style:
+ *   - a batch which fills up means the writes fall behind: the size grows by
+ *     one and the delay follows the smoothed round trip of the ADO calls, so
+ *     each round trip carries more updates;
+ *   - a partial batch means light load: size and delay are halved, down to
+ *     their minimum, for the lowest latency.
+ * The bounds are set per ADO with -B. A batch goes out as one multi-parameter
+ * Set. The setter is synchronous, so one Set per ADO is in flight: the round
+ * trip is amortized over the batch, not hidden by pipelining requests.
+ */
+
+#ifndef INCLado_batchh
+#define INCLado_batchh
+
+#define BATCH_MAX_ADOS 16           /* Max number of ADOs */
+#define BATCH_MIN_SIZE 1            /* Default bounds of the batch size */
+#define BATCH_MAX_SIZE 64
+#define BATCH_MIN_DELAY 0.          /* Default bounds of the flush delay, s */
+#define BATCH_MAX_DELAY 0.05
+#define BATCH_RTT_GAIN 0.125        /* EWMA gain of the smoothed round trip */
+
+extern int  batch_config (const char *spec);
+extern int  batch_add (const char *adoName, const adoItem *item);
+extern void batch_flush_due (void);
+extern void batch_report (FILE *stream);
+
+#endif /* ifndef INCLado_batchh */
@@ -0,0 +1,241 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Timestamp-correlated write groups of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Rounds by CA server timestamp, timeout, one Set per round.
+ * version v02 2026-10-19. Tracepoints around the Set.
+ * version v03 2026-10-19. Warm cache recorded after the Set.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <epicsTime.h>
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "reactor.h"
+#include "ado_group.h"
+#include "warm.h"
+#include "probes.h"
+
+double gGroupTimeout = GROUP_TIMEOUT;
+
+/* Held update of one member */
+typedef struct groupSlot
+{
+    int     present;                // reported in the current round
+    int     n;                      // writes of the update
+    adoItem items[GROUP_MAX_ITEMS];
+    char   *buf;                    // copies of the string and array values
+    size_t  bufSize;
+} groupSlot;
+
+/* One group */
+typedef struct adoGroup
+{
+    char  *name;
+    const char *adoName;
+    int    nMembers;
+    int    nPresent;                // members reported in the current round
+    epicsTimeStamp stamp;           // server timestamp of the current round
+    double tFirst;                  // arrival of the first update of the round
+    int    timer;                   // timeout timer, -1: not created yet
+    int    armed;
+    groupSlot *slots;               // nMembers entries
+    adoItem *items;                 // writes of one Set, nMembers*GROUP_MAX_ITEMS entries
+    unsigned long complete;         // rounds written with all members
+    unsigned long incomplete;       // rounds written on timeout or superseded
+    unsigned long late;             // updates older than the current round
+    unsigned long failed;           // failed writes
+} adoGroup;
+
+static adoGroup gGroups[GROUP_MAX];
+static int gNGroups = 0;
+
+/*+**************************************************************************
+ *
+ * Function:	group_join
+ *
+ * Description:	Add a channel to the group, create the group if it is new
+ *
+ * Arg(s) In:	name    -  Group name, must stay valid
+ *
+ * Arg(s) Out:	grp     -  Group number + 1
+ *              member  -  Member index of the channel
+ *
+ * Return(s):	0 - success, 1 - too many groups or members, no memory
+ *
+ **************************************************************************-*/
+
+int group_join (const char *name, int *grp, int *member)
+{
+    adoGroup *g;
+    groupSlot *p;
+    int ii;
+
+    for (ii = 0; ii < gNGroups; ii++)
+        if (strcmp(gGroups[ii].name, name) == 0) break;
+    if (ii == GROUP_MAX) return 1;
+    g = &gGroups[ii];
+    if (ii == gNGroups) {
+        memset(g, 0, sizeof(*g));
+        g->name = (char *)name;
+        g->timer = -1;
+        gNGroups++;
+    }
+    if (g->nMembers >= GROUP_MAX_MEMBERS) return 1;
+    p = realloc(g->slots, (g->nMembers + 1)*sizeof(groupSlot));
+    if (!p) return 1;
+    g->slots = p;
+    memset(&g->slots[g->nMembers], 0, sizeof(groupSlot));
+    *grp = ii + 1;
+    *member = g->nMembers++;
+    return 0;
+}
+
+/* group_set - one Set of the writes */
+static void group_set (adoGroup *g, int n, const adoItem items[])
+{
+    int failed;
+    E2A_PROBE3(set_begin, g->adoName, n, 1);
+    failed = gAdoSetGroup(g->adoName, n, items);
+    E2A_PROBE3(set_end, g->adoName, n, failed);
+    warm_written(n, items, failed);
+    g->failed += failed;
+}
+
+/* group_flush - write the round with one Set, start the next one */
+static void group_flush (adoGroup *g)
+{
+    int ii, n = 0;
+
+    if (!g->items) {
+        g->items = malloc(g->nMembers*GROUP_MAX_ITEMS*sizeof(adoItem));
+        if (!g->items) return;
+    }
+    for (ii = 0; ii < g->nMembers; ii++)
+    {
+        groupSlot *s = &g->slots[ii];
+        if (!s->present) continue;
+        memcpy(&g->items[n], s->items, s->n*sizeof(adoItem));
+        n += s->n;
+        s->present = 0;
+    }
+    if (g->nPresent == g->nMembers) g->complete++;
+    else                            g->incomplete++;
+    if (gVerb&VERB_DETAILED) printf("Group %s: %i of %i members, %i writes\n",
+                                    g->name, g->nPresent, g->nMembers, n);
+    g->nPresent = 0;
+    group_set(g, n, g->items);
+}
+
+/* Timeout timer: write the incomplete round if it waited long enough, otherwise re-arm */
+static void group_timer (void *arg, int fd)
+{
+    adoGroup *g = arg;
+    double left;
+
+    g->armed = 0;
+    if (!g->nPresent) return;
+    left = g->tFirst + gGroupTimeout - sched_now();
+    if (left > 0.) g->armed = !reactor_set_timer(g->timer, left, 0.);
+    else           group_flush(g);
+}
+
+/* slot_store - keep the writes, string and array values are copied */
+static int slot_store (groupSlot *s, int n, const adoItem items[])
+{
+    size_t offs[GROUP_MAX_ITEMS], len = 0;
+    int ii;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        offs[ii] = len;
+        if (items[ii].count > 1)                   len += items[ii].count*sizeof(double);
+        else if (items[ii].type == adoTypeString) len += strlen(items[ii].str) + 1;
+        len = (len + sizeof(double) - 1) & ~(sizeof(double) - 1);
+    }
+    if (len > s->bufSize) {
+        char *p = realloc(s->buf, len);
+        if (!p) return 1;
+        s->buf = p;
+        s->bufSize = len;
+    }
+    for (ii = 0; ii < n; ii++)
+    {
+        adoItem *it = &s->items[ii];
+        *it = items[ii];
+        if (it->count > 1) {
+            memcpy(s->buf + offs[ii], it->vec, it->count*sizeof(double));
+            it->vec = (double *)(s->buf + offs[ii]);
+        }
+        else if (it->type == adoTypeString) {
+            strcpy(s->buf + offs[ii], it->str);
+            it->str = s->buf + offs[ii];
+        }
+    }
+    s->n = n;
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	group_put
+ *
+ * Description:	Hold the update of the member until its round is complete
+ *
+ * Arg(s) In:	adoName  -  ADO name, must stay valid
+ *              grp      -  Group number + 1, see group_join()
+ *              member   -  Member index
+ *              stamp    -  CA server timestamp of the update
+ *              n        -  Number of writes of the update, max GROUP_MAX_ITEMS
+ *              items    -  The writes, the parameter names must stay valid,
+ *                          string and array values are copied
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int group_put (const char *adoName, int grp, int member, const epicsTimeStamp *stamp,
+               int n, const adoItem items[])
+{
+    adoGroup *g = &gGroups[grp - 1];
+    groupSlot *s = &g->slots[member];
+
+    g->adoName = adoName;
+    if (g->nPresent && !epicsTimeEqual(stamp, &g->stamp))
+    {
+        if (epicsTimeLessThan(stamp, &g->stamp)) {  /* its round is gone */
+            g->late++;
+            group_set(g, n, items);
+            return 0;
+        }
+        group_flush(g);                 /* superseded by the next round */
+    }
+    if (slot_store(s, n, items)) return 1;
+    if (!s->present) {
+        s->present = 1;
+        if (g->nPresent++ == 0) {
+            g->stamp = *stamp;
+            g->tFirst = sched_now();
+            if (g->timer < 0) g->timer = reactor_add_timer(0., 0., group_timer, g);
+            if (g->timer >= 0 && !g->armed)
+                g->armed = !reactor_set_timer(g->timer, gGroupTimeout, 0.);
+        }
+    }
+    if (g->nPresent == g->nMembers) group_flush(g);
+    return 0;
+}
+
+void group_report (FILE *stream)
+{
+    int ii;
+    for (ii = 0; ii < gNGroups; ii++)
+    {
+        adoGroup *g = &gGroups[ii];
+        fprintf(stream, "group %s: members %i, complete %lu, incomplete %lu, late %lu, failed %lu\n",
+                g->name, g->nMembers, g->complete, g->incomplete, g->late, g->failed);
+    }
+}
@@ -0,0 +1,32 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Timestamp-correlated write groups of the epics to ado bridge (grp=<name>)
+ *
+ * The channels of a group are processed together on the IOC and carry the
+ * same CA server timestamp. Their updates are held back until every member
+ * has reported the timestamp of the round, then they are written with one
+ * multi-parameter Set, so ADO clients never see a half updated group. The
+ * timestampSeconds written with the values is the server timestamp of the
+ * round.
+ * A round is written incomplete, also with one Set, when
+ *   - the group timeout (-G) expires after the first update of the round,
+ *   - a member reports a newer timestamp, which starts the next round.
+ * An update older than the current round (a member late for a round which
+ * has already been written) is written on its own.
+ */
+
+#ifndef INCLado_grouph
+#define INCLado_grouph
+
+#define GROUP_MAX 32                /* Max number of groups */
+#define GROUP_MAX_MEMBERS 32        /* Max number of channels of a group */
+#define GROUP_MAX_ITEMS (1+MAP_MAX_OUTS) /* Max writes of one member update */
+#define GROUP_TIMEOUT 0.1           /* Default wait for the missing members, s */
+
+extern double gGroupTimeout;        /* -G option */
+
+extern int  group_join (const char *name, int *grp, int *member);
+extern int  group_put (const char *adoName, int grp, int member, const epicsTimeStamp *stamp,
+                       int n, const adoItem items[]);
+extern void group_report (FILE *stream);
+
+#endif /* ifndef INCLado_grouph */
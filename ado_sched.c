@@ -0,0 +1,491 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Scheduler of ADO writes for the epics to ado bridge
+ *
+ * version v01 2026-10-19. Deficit round robin over per-channel queues.
+ * version v02 2026-10-19. Memory budget, queue depth and overflow policies.
+ * version v03 2026-10-19. Rate limit, hold, per channel counters.
+ * version v04 2026-10-19. Flows cache-line aligned, enqueue/write state in the first line.
+ * version v05 2026-10-19. Tracepoints.
+ * version v06 2026-10-19. Strict priority between the classes, DRR within a class.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "reactor.h"
+#include "ado_sched.h"
+#include "probes.h"
+
+/* Monitor update waiting for the ADO writer, owns a copy of the CA dbr */
+typedef struct update
+{
+    struct update *next;
+    long  dbrType;
+    unsigned long nElems;
+    unsigned long cost;         // size of the dbr, bytes
+    unsigned long cap;          // allocated size of the dbr, bytes
+    double tQueued;             // time of arrival, s
+    double dbr[1];              // dbr copy, double for alignment
+} update;
+
+#define UPDATE_SIZE(cap) (sizeof(update) - sizeof(((update *)0)->dbr) + (cap))
+
+/* Queue of one channel: the state used by every enqueue and write in the
+ * first cache line, the timing, counters and subscription state in the second */
+typedef struct schedFlow
+{
+    update *head;
+    update *tail;
+    update *spare;              // written update kept for reuse
+    struct schedFlow *nextActive;
+    long   deficit;             // DRR deficit counter, bytes
+    int    depth;               // number of queued updates
+    int    maxDepth;            // max number of queued updates
+    OverflowT policy;           // what to do when the queue is full
+    int    active;              // flow is in the active list
+    int    cls;                 // priority class
+    int    delayed;             // out of the active list until tNext
+    double tNext;               // earliest time of the next write
+    double minInterval;         // rate limit: min time between writes, s, 0: none
+    double tLastEvent;          // arrival of the last update
+    unsigned long events;       // updates received
+    unsigned long written;      // updates handed to the writer
+    unsigned long dropped;      // updates lost on overflow
+    int    paused;              // subscription stopped by the ovfBlock policy
+    int    held;                // subscription stopped by sched_hold()
+} PV_ALIGNED schedFlow;
+
+schedStats gSchedStats[SCHED_NCLASS];
+unsigned long gSchedBudget = SCHED_MEMORY_BUDGET*1024UL;
+unsigned long gSchedBytes = 0;
+const char *gOverflowNames[] = {"latest", "oldest", "block", NULL};
+
+static pv *gSchedPvs = NULL;
+static int gSchedNPvs = 0;
+static schedFlow *gFlows = NULL;
+static schedFlow *gActiveHead[SCHED_NCLASS], *gActiveTail[SCHED_NCLASS];  // per class
+static void (*gSchedWriter)(pv *) = NULL;
+static void (*gSchedPause)(pv *, int) = NULL;
+static int gDelayTimer = -1;                    // wakes up the rate limited flows
+static double gDelayDue = 0.;                   // expiration of gDelayTimer, 0: disarmed
+
+double sched_now (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1.e-9*ts.tv_nsec;
+}
+
+static void active_push (schedFlow *f)
+{
+    int cls = f->cls;
+    f->nextActive = NULL;
+    if (gActiveTail[cls]) gActiveTail[cls]->nextActive = f;
+    else                  gActiveHead[cls] = f;
+    gActiveTail[cls] = f;
+    f->active = 1;
+}
+
+/* Next flow of the highest class with queued updates */
+static schedFlow *active_pop (void)
+{
+    schedFlow *f = NULL;
+    int cls;
+
+    for (cls = SCHED_NCLASS-1; cls >= 0 && !gActiveHead[cls]; cls--) ;
+    if (cls >= 0) {
+        f = gActiveHead[cls];
+        gActiveHead[cls] = f->nextActive;
+        if (!gActiveHead[cls]) gActiveTail[cls] = NULL;
+        f->active = 0;
+    }
+    return f;
+}
+
+/* Release the update, keep the largest one of the flow for reuse */
+static void update_release (schedFlow *f, update *u)
+{
+    if (f->spare && f->spare->cap >= u->cap) {
+        gSchedBytes -= UPDATE_SIZE(u->cap);
+        free(u);
+        return;
+    }
+    if (f->spare) {
+        gSchedBytes -= UPDATE_SIZE(f->spare->cap);
+        free(f->spare);
+    }
+    f->spare = u;
+}
+
+/* Get a buffer for size bytes of dbr within the memory budget, NULL if none */
+static update *update_acquire (schedFlow *f, unsigned long size)
+{
+    update *u = f->spare;
+    if (u && u->cap >= size) {
+        f->spare = NULL;
+        return u;
+    }
+    if (gSchedBytes + UPDATE_SIZE(size) > gSchedBudget) return NULL;
+    u = malloc(UPDATE_SIZE(size));
+    if (!u) return NULL;
+    u->cap = size;
+    gSchedBytes += UPDATE_SIZE(size);
+    return u;
+}
+
+static update *queue_pop (schedFlow *f)
+{
+    update *u = f->head;
+    f->head = u->next;
+    if (!f->head) f->tail = NULL;
+    f->depth--;
+    gSchedStats[f->cls].queued--;
+    return u;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	sched_init
+ *
+ * Description:	Allocate the channel queues
+ *
+ * Arg(s) In:	pvs     -  Pointer to an array of pv structures
+ *              nPvs    -  Number of elements in the pvs array
+ *              writer  -  Called for each scheduled update, with pv->value,
+ *                         pv->dbrType and pv->nElems set to the update
+ *
+ * Return(s):	0 - success, 1 - allocation failed
+ *
+ **************************************************************************-*/
+
+int sched_init (pv *pvs, int nPvs, void (*writer)(pv *))
+{
+    int n;
+    if (posix_memalign((void **)&gFlows, PV_CACHE_LINE, nPvs*sizeof(schedFlow)))
+        return 1;
+    memset(gFlows, 0, nPvs*sizeof(schedFlow));
+    for (n = 0; n < nPvs; n++) {
+        gFlows[n].policy = ovfLatest;
+        gFlows[n].maxDepth = 1;
+    }
+    gSchedPvs = pvs;
+    gSchedNPvs = nPvs;
+    gSchedWriter = writer;
+    memset(gSchedStats, 0, sizeof(gSchedStats));
+    return 0;
+}
+
+void sched_set_class (pv *ppv, int cls)
+{
+    if (cls < 0) cls = 0;
+    if (cls >= SCHED_NCLASS) cls = SCHED_NCLASS-1;
+    gFlows[ppv - gSchedPvs].cls = cls;
+}
+
+// sched_set_overflow
+// set the overflow policy and the max number of queued updates of the channel,
+// depth <= 0 selects the default SCHED_DEPTH, the ovfLatest policy implies depth 1
+void sched_set_overflow (pv *ppv, OverflowT policy, int depth)
+{
+    schedFlow *f = &gFlows[ppv - gSchedPvs];
+    f->policy = policy;
+    f->maxDepth = policy == ovfLatest ? 1 : (depth > 0 ? depth : SCHED_DEPTH);
+}
+
+// sched_set_pause_handler
+// the handler stops (pause=1) or restarts (pause=0) the CA subscription of the channel
+void sched_set_pause_handler (void (*pause)(pv *, int))
+{
+    gSchedPause = pause;
+}
+
+// sched_overflow_policy
+// return the OverflowT for the policy name, -1 if not known
+int sched_overflow_policy (const char *name)
+{
+    int ii;
+    for (ii=0; gOverflowNames[ii]; ii++)
+        if (strcmp(gOverflowNames[ii], name) == 0) return ii;
+    return -1;
+}
+
+// sched_ca_priority
+// CA priority for the channels of the priority class, the -p option is the base
+capri sched_ca_priority (int cls)
+{
+    unsigned pri = caPriority + cls*SCHED_CA_PRIORITY_STEP;
+    return pri > CA_PRIORITY_MAX ? CA_PRIORITY_MAX : pri;
+}
+
+static void flow_pause (schedFlow *f, int pause)
+{
+    if (f->paused == pause || !gSchedPause) return;
+    f->paused = pause;
+    if (pause) gSchedStats[f->cls].blocked++;
+    if (f->held) return;        /* the subscription stays stopped until released */
+    if (gVerb&VERB_DEBUG) printf("%s subscription of %s\n", pause ? "Stopped" : "Restarted",
+                                 gSchedPvs[f - gFlows].name);
+    gSchedPause(&gSchedPvs[f - gFlows], pause);
+}
+
+static void flow_dropped (schedFlow *f)
+{
+    E2A_PROBE2(drop, (int)(f - gFlows), (int)f->policy);
+    gSchedStats[f->cls].dropped++;
+    f->dropped++;
+}
+
+/* Delay timer: return the rate limited flows whose time came to the active list */
+static void delay_timer (void *arg, int fd)
+{
+    double now = sched_now(), due = 0.;
+    int n;
+
+    for (n = 0; n < gSchedNPvs; n++)
+    {
+        schedFlow *f = &gFlows[n];
+        if (!f->delayed) continue;
+        if (f->tNext <= now) {
+            f->delayed = 0;
+            if (f->head && !f->active) active_push(f);
+        }
+        else if (due == 0. || f->tNext < due) due = f->tNext;
+    }
+    gDelayDue = due;
+    if (due > 0.) reactor_set_timer(gDelayTimer, due - now, 0.);
+}
+
+/* Take the flow out of the active list until its next write is allowed */
+static void flow_delay (schedFlow *f, double now)
+{
+    f->delayed = 1;
+    if (gDelayDue == 0. || f->tNext < gDelayDue) {
+        gDelayDue = f->tNext;
+        reactor_set_timer(gDelayTimer, f->tNext - now, 0.);
+    }
+}
+
+// sched_set_rate
+// limit the writes of the channel to rate per second, 0: no limit
+void sched_set_rate (pv *ppv, double rate)
+{
+    schedFlow *f = &gFlows[ppv - gSchedPvs];
+    if (rate > 0. && gDelayTimer < 0) {
+        gDelayTimer = reactor_add_timer(0., 0., delay_timer, NULL);
+        if (gDelayTimer < 0) return;
+    }
+    f->minInterval = rate > 0. ? 1./rate : 0.;
+    if (f->tNext > sched_now() + f->minInterval) f->tNext = 0.;  /* rate raised */
+}
+
+// sched_hold
+// stop (hold=1) or restart (hold=0) the subscription of the channel on request,
+// independent of the ovfBlock policy; the queued updates are still written
+void sched_hold (pv *ppv, int hold)
+{
+    schedFlow *f = &gFlows[ppv - gSchedPvs];
+    hold = hold != 0;
+    if (f->held == hold || !gSchedPause) return;
+    f->held = hold;
+    if (!f->paused) gSchedPause(ppv, hold);
+}
+
+void sched_flow_info (pv *ppv, schedFlowInfo *info)
+{
+    schedFlow *f = &gFlows[ppv - gSchedPvs];
+    info->cls = f->cls;
+    info->depth = f->depth;
+    info->maxDepth = f->maxDepth;
+    info->policy = f->policy;
+    info->paused = f->paused;
+    info->held = f->held;
+    info->rate = f->minInterval > 0. ? 1./f->minInterval : 0.;
+    info->events = f->events;
+    info->written = f->written;
+    info->dropped = f->dropped;
+    info->tLastEvent = f->tLastEvent;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	sched_enqueue
+ *
+ * Description:	Copy the monitor update to the queue of its channel,
+ *              called from the CA event handler. Applies the overflow
+ *              policy of the channel when the queue is full or the memory
+ *              budget is spent
+ *
+ * Return(s):	0 - queued, 1 - update lost
+ *
+ **************************************************************************-*/
+
+int sched_enqueue (pv *ppv, long dbrType, unsigned long count, const void *dbr)
+{
+    schedFlow *f = &gFlows[ppv - gSchedPvs];
+    schedStats *st = &gSchedStats[f->cls];
+    unsigned long size = dbr_size_n(dbrType, count);
+    update *u = NULL;
+    double now = sched_now();
+
+    f->events++;
+    f->tLastEvent = now;
+    if (f->paused || f->held) { /* late event of a stopped subscription */
+        flow_dropped(f);
+        return 1;
+    }
+                                /* Coalesce to latest in place */
+    if (f->policy == ovfLatest && f->head && f->head->cap >= size)
+    {
+        u = f->head;
+        u->dbrType = dbrType;
+        u->nElems = count;
+        u->cost = size;
+        memcpy(u->dbr, dbr, size);
+        st->coalesced++;
+        E2A_PROBE2(coalesce, (int)(f - gFlows), f->depth);
+        return 0;
+    }
+    if (f->depth < f->maxDepth) u = update_acquire(f, size);
+
+    while (!u && f->head)       /* Queue full or no memory */
+    {
+        if (f->policy == ovfBlock) {
+            flow_pause(f, 1);
+            flow_dropped(f);
+            return 1;
+        }
+        update_release(f, queue_pop(f));  /* ovfLatest and ovfOldest */
+        if (f->policy == ovfLatest) {
+            st->coalesced++;
+            E2A_PROBE2(coalesce, (int)(f - gFlows), f->depth);
+        }
+        else flow_dropped(f);
+        u = update_acquire(f, size);
+        if (!u && f->spare) {   /* the spare is too small for the new size */
+            gSchedBytes -= UPDATE_SIZE(f->spare->cap);
+            free(f->spare);
+            f->spare = NULL;
+            u = update_acquire(f, size);
+        }
+    }
+    if (!u) {                   /* Memory budget spent by the other channels */
+        if (f->policy == ovfBlock) flow_pause(f, 1);
+        flow_dropped(f);
+        return 1;
+    }
+    u->next = NULL;
+    u->dbrType = dbrType;
+    u->nElems = count;
+    u->cost = size;
+    u->tQueued = now;
+    memcpy(u->dbr, dbr, size);
+
+    if (f->tail) f->tail->next = u;
+    else         f->head = u;
+    f->tail = u;
+    f->depth++;
+    if (!f->active && !f->delayed) active_push(f);
+
+    st->enqueued++;
+    st->queued++;
+    return 0;
+}
+
+int sched_pending (void)
+{
+    int cls;
+    for (cls = 0; cls < SCHED_NCLASS; cls++)
+        if (gActiveHead[cls]) return 1;
+    return 0;
+}
+
+static void sched_write (schedFlow *f, update *u, double now)
+{
+    pv *ppv = &gSchedPvs[f - gFlows];
+    schedStats *st = &gSchedStats[f->cls];
+    double wait = now - u->tQueued;
+
+    E2A_PROBE2(dequeue, (int)(f - gFlows), (long long)(wait*1e9));
+    if (wait > st->maxWait) st->maxWait = wait;
+    st->written++;
+    f->written++;
+
+    ppv->dbrType = u->dbrType;
+    ppv->nElems = u->nElems;
+    ppv->value = u->dbr;
+    gSchedWriter(ppv);
+    ppv->value = NULL;
+    update_release(f, u);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	sched_drain
+ *
+ * Description:	Hand the queued updates to the writer, the highest class
+ *              first, in deficit round robin order within a class, until
+ *              the queues are empty or the time budget is spent. Restarts
+ *              the stopped subscriptions of the drained channels
+ *
+ * Arg(s) In:	budget  -  Time budget, s
+ *
+ * Return(s):	Number of updates written
+ *
+ **************************************************************************-*/
+
+int sched_drain (double budget)
+{
+    double tStart = sched_now(), now = tStart;
+    int nWritten = 0;
+    schedFlow *f;
+
+    while ((f = active_pop()) != NULL)
+    {
+        if (f->minInterval > 0. && f->tNext > now) {
+            flow_delay(f, now);     /* rate limited, back from delay_timer() */
+            continue;
+        }
+        f->deficit += SCHED_QUANTUM_OF(f->cls);
+        while (f->head && f->head->cost <= f->deficit)
+        {
+            update *u = queue_pop(f);
+            f->deficit -= u->cost;
+            sched_write(f, u, now);
+            nWritten++;
+            if (f->minInterval > 0.) {
+                f->tNext = now + f->minInterval;
+                break;
+            }
+        }
+        if (f->head) active_push(f);
+        else {
+            f->deficit = 0;     /* idle flows do not accumulate credit */
+            if (f->paused) flow_pause(f, 0);
+        }
+
+        now = sched_now();
+        if (now - tStart > budget) break;
+    }
+    if (nWritten) fflush(stdout);
+    return nWritten;
+}
+
+void sched_report (FILE *stream)
+{
+    int cls;
+    fprintf(stream, "queue memory %lu of %lu bytes\n", gSchedBytes, gSchedBudget);
+    for (cls = 0; cls < SCHED_NCLASS; cls++)
+    {
+        schedStats *st = &gSchedStats[cls];
+        if (!st->enqueued) continue;
+        fprintf(stream, "class %i: enqueued %lu, written %lu, queued %lu, coalesced %lu, "
+                "dropped %lu, blocked %lu, max wait %.6f s\n",
+                cls, st->enqueued, st->written, st->queued, st->coalesced,
+                st->dropped, st->blocked, st->maxWait);
+    }
+}
@@ -0,0 +1,100 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Scheduler of ADO writes for the epics to ado bridge
+ *
+ * Monitor updates are copied out of the CA callback into per-channel queues
+ * and handed to the ADO writer. The priority classes (prio=<n> in the csv
+ * map, higher is more urgent) are served in strict priority: a class is
+ * served only while all higher classes have nothing queued. Within a class
+ * a deficit round robin shares the writes, the cost of an update is its
+ * size in bytes, so a chatty waveform cannot starve the scalar parameters
+ * of its class. Guarantee: an update of class c waits only for the updates
+ * of the higher classes and of class c queued before it, for at most one
+ * quantum of the lower class flow in service when it arrived
+ * (SCHED_QUANTUM_OF of that class, one update if larger), and for the CA
+ * callbacks of one loop iteration. The
+ * lower classes get the write capacity the higher ones leave and can be
+ * starved by them; their max wait is reported per class.
+ *
+ * The memory of the queues is bounded by a hard budget (-M option) and a
+ * maximum depth per channel. When a queue overflows, the overflow policy of
+ * the channel (ovf=<policy> in the csv map) decides what is lost:
+ *   latest - keep only the latest update of the channel (default)
+ *   oldest - drop the oldest queued update of the channel
+ *   block  - stop the CA subscription of the channel until its queue drains,
+ *            the current value is delivered again on re-subscription
+ *
+ * A channel can be rate limited (rate=<hz> in the csv map or at runtime
+ * through the control socket): it is written at most once per 1/rate
+ * seconds, the updates in between are queued under its overflow policy.
+ * A held channel (paused through the control socket) has its subscription
+ * stopped until it is released.
+ */
+
+#ifndef INCLado_schedh
+#define INCLado_schedh
+
+#include <stdio.h>
+
+#define SCHED_NCLASS 4              /* Number of priority classes */
+#define SCHED_QUANTUM 256           /* DRR quantum of class 0, bytes */
+#define SCHED_QUANTUM_SHIFT 2       /* Quantum grows 4x with each class: the
+                                       higher classes are served in longer runs */
+#define SCHED_CA_PRIORITY_STEP 10   /* CA priority increment per class */
+#define SCHED_DRAIN_BUDGET 0.01     /* Max time spent in one sched_drain(), s */
+#define SCHED_REPORT_PERIOD 10.     /* Period of statistics printout (-v2), s */
+#define SCHED_MEMORY_BUDGET 16384   /* Default memory budget of the queues, kB */
+#define SCHED_DEPTH 8               /* Default max queued updates per channel */
+
+/* Overflow policies, order must match gOverflowNames */
+typedef enum { ovfLatest, ovfOldest, ovfBlock } OverflowT;
+
+#define SCHED_QUANTUM_OF(cls) (SCHED_QUANTUM << (SCHED_QUANTUM_SHIFT*(cls)))
+
+/* Statistics per priority class */
+typedef struct schedStats
+{
+    unsigned long enqueued;     // updates accepted from CA
+    unsigned long written;      // updates handed to the ADO writer
+    unsigned long queued;       // updates waiting now
+    unsigned long coalesced;    // updates overwritten by a newer one
+    unsigned long dropped;      // updates lost on overflow
+    unsigned long blocked;      // subscriptions stopped on overflow
+    double maxWait;             // longest queueing delay, s
+} schedStats;
+
+/* State of one channel, see sched_flow_info() */
+typedef struct schedFlowInfo
+{
+    int    cls;
+    int    depth, maxDepth;     // queued updates, max
+    OverflowT policy;
+    int    paused;              // subscription stopped by the ovfBlock policy
+    int    held;                // subscription stopped by sched_hold()
+    double rate;                // rate limit, Hz, 0: none
+    unsigned long events;       // updates received from CA
+    unsigned long written;      // updates handed to the writer
+    unsigned long dropped;      // updates lost on overflow
+    double tLastEvent;          // sched_now() of the last update, 0: none yet
+} schedFlowInfo;
+
+extern schedStats gSchedStats[SCHED_NCLASS];
+extern unsigned long gSchedBudget;  /* Memory budget of the queues, bytes */
+extern unsigned long gSchedBytes;   /* Memory used by the queues, bytes */
+extern const char *gOverflowNames[];
+
+extern int    sched_init (pv *pvs, int nPvs, void (*writer)(pv *));
+extern void   sched_set_class (pv *ppv, int cls);
+extern void   sched_set_overflow (pv *ppv, OverflowT policy, int depth);
+extern void   sched_set_pause_handler (void (*pause)(pv *, int));
+extern int    sched_overflow_policy (const char *name);
+extern void   sched_set_rate (pv *ppv, double rate);
+extern void   sched_hold (pv *ppv, int hold);
+extern void   sched_flow_info (pv *ppv, schedFlowInfo *info);
+extern capri  sched_ca_priority (int cls);
+extern int    sched_enqueue (pv *ppv, long dbrType, unsigned long count, const void *dbr);
+extern int    sched_pending (void);
+extern int    sched_drain (double budget);
+extern void   sched_report (FILE *stream);
+extern double sched_now (void);
+
+#endif /* ifndef INCLado_schedh */
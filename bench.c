@@ -0,0 +1,260 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Micro-benchmarks of the epics to ado bridge
+ *
+ * version v01 2026-10-19. val2str, val2double, dbr2str, pv2param, map parsing,
+ *                         ADO value construction; JSON lines output.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "bench.h"
+
+typedef void benchFunc (void *arg);
+
+/* Arguments of a case */
+typedef struct benchArg
+{
+    long   type;                    // DBR type
+    unsigned long count;            // elements or rows
+    void  *dbr;                     // value
+    mapRec *map;                    // map of pv2param and parsemap
+    char  **names;                  // PV names to look up
+    unsigned long next;             // next name
+    const char *file;               // map file of parsemap
+    char  *storage;                 // token storage of parsemap
+    size_t storageSize;
+    adoItem item;                   // write of adovalue
+} benchArg;
+
+static const char *gTypeNames[] = {"STRING", "SHORT", "FLOAT", "ENUM", "CHAR", "LONG", "DOUBLE"};
+static volatile double gSink;       /* keeps the results alive */
+
+/* Time per call of fn, repeated until it ran for BENCH_MIN_TIME */
+static double bench_time (benchFunc *fn, void *arg, unsigned long *iters)
+{
+    unsigned long n = 1, ii;
+    double t0, dt;
+
+    fn(arg);                            /* warm up the caches */
+    for (;;)
+    {
+        t0 = sched_now();
+        for (ii = 0; ii < n; ii++) fn(arg);
+        dt = sched_now() - t0;
+        if (dt >= BENCH_MIN_TIME) break;
+        n = dt > BENCH_MIN_TIME/100. ? n*1.2*BENCH_MIN_TIME/dt + 1 : n*10;
+    }
+    *iters = n;
+    return dt/n;
+}
+
+static void bench_print (FILE *out, const char *bench, const char *type, unsigned long count,
+                         benchFunc *fn, benchArg *arg)
+{
+    unsigned long iters;
+    double t = bench_time(fn, arg, &iters)*1e9;
+
+    fprintf(out, "{\"bench\":\"%s\",", bench);
+    if (type) fprintf(out, "\"type\":\"%s\",", type);
+    fprintf(out, "\"%s\":%lu,\"iters\":%lu,\"ns_per_op\":%.1f,\"ns_per_elem\":%.2f}\n",
+            strcmp(bench, "pv2param") == 0 || strcmp(bench, "parsemap") == 0 ? "rows" : "elems",
+            count, iters, t, t/count);
+    fflush(out);
+}
+
+static void fn_val2str (void *p)
+{
+    benchArg *a = p;
+    unsigned long ii;
+    size_t len = 0;
+    for (ii = 0; ii < a->count; ii++) len += strlen(val2str(a->dbr, a->type, ii));
+    gSink = len;
+}
+
+static void fn_val2double (void *p)
+{
+    benchArg *a = p;
+    unsigned long ii;
+    double sum = 0.;
+    for (ii = 0; ii < a->count; ii++) sum += val2double(a->dbr, a->type, ii);
+    gSink = sum;
+}
+
+static void fn_dbr2str (void *p)
+{
+    benchArg *a = p;
+    gSink = strlen(dbr2str(a->dbr, a->type));
+}
+
+static void fn_pv2param (void *p)
+{
+    benchArg *a = p;
+    gSink = strlen(pv2param(a->names[a->next], a->map, a->count));
+    a->next = (a->next + 7919) % a->count;    /* spread over the map */
+}
+
+static void fn_parsemap (void *p)
+{
+    benchArg *a = p;
+    gSink = parse_epics2ado_csvmap(a->file, '>', a->map, a->count, a->storage, a->storageSize);
+}
+
+static void fn_adovalue (void *p)
+{
+    benchArg *a = p;
+    adoMakeValues(1, &a->item);
+}
+
+/* DBR_TIME value of the type with count elements */
+static void *make_dbr (long type, unsigned long count)
+{
+    char *dbr = calloc(1, dbr_size_n(type, count));
+    char *val;
+    unsigned long ii;
+
+    if (!dbr) return NULL;
+    val = dbr_value_ptr(dbr, type);
+    for (ii = 0; ii < count; ii++)
+        switch (type) {
+        case DBR_TIME_STRING: sprintf(((dbr_string_t *)val)[ii], "value %lu", ii); break;
+        case DBR_TIME_SHORT:  ((dbr_short_t *)val)[ii] = ii; break;
+        case DBR_TIME_FLOAT:  ((dbr_float_t *)val)[ii] = ii*1.5; break;
+        case DBR_TIME_ENUM:   ((dbr_enum_t *)val)[ii] = ii % 16; break;
+        case DBR_TIME_CHAR:   ((dbr_char_t *)val)[ii] = 'a' + ii % 26; break;
+        case DBR_TIME_LONG:   ((dbr_long_t *)val)[ii] = ii*1000; break;
+        case DBR_TIME_DOUBLE: ((dbr_double_t *)val)[ii] = ii*0.001; break;
+        }
+    epicsTimeGetCurrent(&((struct dbr_time_double *)dbr)->stamp);
+    return dbr;
+}
+
+static int bench_values (FILE *out)
+{
+    static const unsigned long sizes[] = {1, 100, BENCH_MAX_ELEMS};
+    benchArg a;
+    int t, s;
+
+    memset(&a, 0, sizeof(a));
+    for (t = 0; t <= DBR_DOUBLE; t++)
+    {
+        a.type = DBR_TIME_STRING + t;
+        for (s = 0; s < 3; s++)
+        {
+            a.count = sizes[s];
+            a.dbr = make_dbr(a.type, a.count);
+            if (!a.dbr) return 1;
+            bench_print(out, "val2str", gTypeNames[t], a.count, fn_val2str, &a);
+            if (a.type != DBR_TIME_STRING)
+                bench_print(out, "val2double", gTypeNames[t], a.count, fn_val2double, &a);
+            if (s == 0) bench_print(out, "dbr2str", gTypeNames[t], 1, fn_dbr2str, &a);
+            free(a.dbr);
+        }
+    }
+    return 0;
+}
+
+/* Map of n rows: in memory for pv2param, as csv file for parsemap */
+static int bench_maps (FILE *out)
+{
+    static const unsigned long sizes[] = {10, 100, 1000, 10000, BENCH_MAX_ROWS};
+    char file[] = "/tmp/epics2ado_benchXXXXXX";
+    benchArg a;
+    unsigned long ii;
+    int s, fd, rc = 1;
+    FILE *f;
+
+    memset(&a, 0, sizeof(a));
+    a.map = calloc(BENCH_MAX_ROWS, sizeof(mapRec));
+    a.names = calloc(BENCH_MAX_ROWS, sizeof(char *));
+    a.storageSize = BENCH_MAX_ROWS*64;
+    a.storage = malloc(a.storageSize);
+    fd = mkstemp(file);
+    if (!a.map || !a.names || !a.storage || fd < 0) goto done;
+    close(fd);
+    a.file = file;
+    for (s = 0; s < 5; s++)
+    {
+        a.count = sizes[s];
+        f = fopen(file, "w");
+        if (!f) goto done;
+        fprintf(f, "# generated map of %lu rows\n", a.count);
+        for (ii = 0; ii < a.count; ii++)
+            fprintf(f, ",bench:pv%06lu,>,param%06lu%s\n", ii, ii, ii % 10 ? "" : ",prio=1,rate=10");
+        fclose(f);
+        bench_print(out, "parsemap", NULL, a.count, fn_parsemap, &a);
+        for (ii = 0; ii < a.count; ii++) a.names[ii] = a.map[ii].pvName;
+        a.next = 0;
+        bench_print(out, "pv2param", NULL, a.count, fn_pv2param, &a);
+    }
+    rc = 0;
+done:
+    if (fd >= 0) unlink(file);
+    free(a.map);
+    free(a.names);
+    free(a.storage);
+    return rc;
+}
+
+static int bench_ado_values (FILE *out)
+{
+    static const char *typeNames[] = {"", "", "string", "int", "double"};
+    static const unsigned long sizes[] = {1, 100, BENCH_MAX_ELEMS};
+    double *vec = malloc(BENCH_MAX_ELEMS*sizeof(double));
+    benchArg a;
+    unsigned long ii;
+    int t, s;
+
+    if (!vec) return 1;
+    for (ii = 0; ii < BENCH_MAX_ELEMS; ii++) vec[ii] = ii*0.5;
+    memset(&a, 0, sizeof(a));
+    a.item.param = "benchS";
+    a.item.str = "12.345";
+    a.item.num = 12.345;
+    a.item.vec = vec;
+    for (t = adoTypeString; t <= adoTypeDouble; t++)
+        for (s = 0; s < 3; s++)
+        {
+            if (t == adoTypeString && s) break;
+            a.item.type = t;
+            a.item.count = sizes[s];
+            bench_print(out, "adovalue", typeNames[t], a.item.count, fn_adovalue, &a);
+        }
+    free(vec);
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	bench_run
+ *
+ * Description:	Run all benchmarks
+ *
+ * Arg(s) In:	filename  -  Output file of the JSON lines, '-': stdout
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int bench_run (const char *filename)
+{
+    FILE *out = strcmp(filename, "-") == 0 ? stdout : fopen(filename, "w");
+    int verb = gVerb, rc;
+
+    if (!out) {
+        perror(filename);
+        return 1;
+    }
+    gVerb = 0;                          /* the stages must not print */
+    rc = bench_values(out) || bench_maps(out) || bench_ado_values(out);
+    gVerb = verb;
+    if (out != stdout) fclose(out);
+    if (rc) fprintf(stderr, "Benchmark failed: out of memory or no temporary file\n");
+    return rc;
+}
@@ -0,0 +1,28 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Micro-benchmarks of the epics to ado bridge (-X option)
+ *
+ * Times the stages which run on every event or at startup, one at a time:
+ *   val2str    all elements of scalars and arrays of each DBR_TIME type
+ *   val2double the same, numeric conversion
+ *   dbr2str    status/severity/timestamp text of each DBR_TIME type
+ *   pv2param   lookup of the ADO parameter in maps of 10 to 100k rows
+ *   parsemap   parse_epics2ado_csvmap() of generated maps of 10 to 100k rows
+ *   adovalue   construction of the ADO Values of scalar and array writes
+ * Each case is repeated until it ran for BENCH_MIN_TIME. The results go out
+ * as JSON lines, one per case:
+ *   {"bench":"val2str","type":"LONG","elems":100,"iters":20480,
+ *    "ns_per_op":1834.2,"ns_per_elem":18.34}
+ * ns_per_op is the time of one call of the stage (one event, one lookup,
+ * one map), ns_per_elem divides it by the elements or rows.
+ */
+
+#ifndef INCLbenchh
+#define INCLbenchh
+
+#define BENCH_MIN_TIME 0.2          /* Min run time of a case, s */
+#define BENCH_MAX_ELEMS 10000       /* Largest array size */
+#define BENCH_MAX_ROWS 100000       /* Largest map size */
+
+extern int bench_run (const char *filename);
+
+#endif /* ifndef INCLbenchh */
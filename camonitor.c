@@ -30,6 +30,38 @@
 // Version v07 2016-07-27 by AS. Checked for memory leaks, valgrind reports 20-byte leak but 10-hour run shows no memory increase.
 // Version v08 2016-08-04 by AS. TODO Need cleanup
 //                               TODO handle arrays, strings and other settable PVs, marked '<'
+// Version v09 2026-10-19. Map options (prio=<n>), ADO writes scheduled by priority class.
+// Version v10 2026-10-19. Bounded write queues: memory budget (-M), overflow policies (ovf=, depth=).
+// Version v11 2026-10-19. Event loop on epoll: CA fds, timers, ca_poll() only when readable.
+// Version v12 2026-10-19. Monitor output of the events (-o text|json|bin), buffered.
+// Version v13 2026-10-19. Native DBR types for the monitors, enum strings and precision from the metadata cache.
+// Version v14 2026-10-19. Per-mapping event mask, element count and dynamic array options (mask=, nelm=, dyn=).
+// Version v15 2026-10-19. Soak test mode (-K, -k) with RSS, heap and fd growth check.
+// Version v16 2026-10-19. ADO writes batched per ADO, batch size and delay adapted to the ADO round trip (-B).
+// Version v17 2026-10-19. ADO parameter types discovered at startup, values converted directly to them.
+// Version v18 2026-10-19. Control socket (-C): channel state, statistics, pause/resume, rate limits (rate=), verbosity.
+// Version v19 2026-10-19. Value transforms (xf=), arrays forwarded to ADO array parameters.
+// Version v20 2026-10-19. Waveform reduction (red=) in the event path, extra output parameters (out=).
+// Version v21 2026-10-19. Write groups (grp=, -G): updates with the same server timestamp written with one Set.
+// Version v22 2026-10-19. Warm restart cache (-W): unchanged first values are not written after a restart.
+// Version v23 2026-10-19. Thread placement (-A, -a, -N): CPU affinity, SCHED_FIFO, NUMA memory policy.
+// Version v24 2026-10-19. Micro-benchmarks of the conversion and mapping stages (-X).
+// Version v25 2026-10-19. Rule rows with wildcards, expanded for the PVs of a list (-L), up to 10000 records.
+// Version v26 2026-10-19. One subscription per PV, fanned out to all its map records (ado=), value converted once.
+// Version v27 2026-10-19. Echo suppression of the bidirectional ('x') map records.
+// Version v28 2026-10-19. pvAccess ingestion of the map records with src=pva (field=).
+// Version v29 2026-10-19. Latest values published in a shared-memory table (-P).
+// Version v30 2026-10-19. Channel structures cache-line aligned, hot fields first.
+// Version v31 2026-10-19. Static tracepoints (USDT) of the pipeline stages, see probes.h.
+// Version v32 2026-10-19. Supervisor mode (-j, -J): the map split into shards bridged by worker processes.
+// Version v33 2026-10-19. Delta mode (delta=): values equal to the last written one are not written.
+// Version v34 2026-10-19. Self-checks (-T).
+// Version v35 2026-10-19. CA threads placed (-a) by thread id after the channels connect.
+// Version v36 2026-10-19. 'x' rows: repeats of the last ADO write dropped, one direction.
+// Version v37 2026-10-19. Enum updates held until the enum strings arrive.
+// Version v38 2026-10-19. Write groups stamped with the server timestamp of the round.
+// Version v39 2026-10-19. Delta mode of string values.
+// Version v40 2026-10-19. stdout buffer of -o text set before the first output.
 
 #include <stdio.h>
 #include <epicsStdlib.h>
@@ -39,6 +71,28 @@
 #include <epicsGetopt.h>
 
 #include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "reactor.h"
+#include "mon_out.h"
+#include "pv_meta.h"
+#include "ado_batch.h"
+#include "soak.h"
+#include "ctl.h"
+#include "xf.h"
+#include "reduce.h"
+#include "ado_group.h"
+#include "warm.h"
+#include "place.h"
+#include "bench.h"
+#include "check.h"
+#include "rules.h"
+#include "echo.h"
+#include "pva_in.h"
+#include "shm_pub.h"
+#include "probes.h"
+#include "super.h"
+#include "delta.h"
 
 void usage (const char* progname)
 {
@@ -47,6 +101,94 @@ void usage (const char* progname)
     "\n"
     "  -h:       Help; Print this message\n"
     "  -v:       Verbosity mask: 1-info, 2-debug, 4-detailed. Default: 1\n"
+    "Map file options, optional columns of a map record in the form key=value:\n"
+    "  prio=<n>: Priority class 0-%u (default 0=lowest). Selects the CA priority\n"
+    "            (-p value + %u*<n>) and the share of the ADO writes\n"
+    "  ovf=<p>:  Overflow policy when ADO writes fall behind: 'latest' - keep only\n"
+    "            the latest value (default), 'oldest' - drop the oldest queued\n"
+    "            value, 'block' - stop the subscription until the queue drains\n"
+    "  depth=<n>: Max number of queued values for 'oldest' and 'block', default %u\n"
+    "  mask=<msk>: CA event mask of the channel, letters as for -m, e.g. 'l' to\n"
+    "            forward only the archive (DBE_LOG) updates. Default: -m\n"
+    "  nelm=<n>: Request up to <n> array elements. Default: -#\n"
+    "  dyn=0|1:  1 (default) - request the current length of dynamic arrays,\n"
+    "            0 - always request the full length\n"
+    "  xf=<expr>: Transform the value before writing it, e.g. x*0.001+273.15,\n"
+    "            clamp((x>>4)&255;0;100); function arguments are separated by\n"
+    "            ';'. Applied element-wise to arrays (see xf.h)\n"
+    "  rate=<hz>: Write the channel to ADO at most <hz> times per second,\n"
+    "            the updates in between are coalesced. Default: no limit\n"
+    "  red=<kind>: Reduce arrays when they arrive, before queuing: 'dec:<n>' -\n"
+    "            every n-th element, 'avg:<n>' - block averages, 'env:<n>' -\n"
+    "            block minima followed by block maxima, 'stats' - mean, rms,\n"
+    "            min, max, std. The result is a double array (see reduce.h)\n"
+    "  out=<p1>;..: Up to %u further parameters of a reduced channel, written as\n"
+    "            double; the result is split evenly between param and them\n"
+    "  grp=<name>: Write group: the updates of its channels are held until all\n"
+    "            have the same server timestamp, then written with one Set\n"
+    "  src=ca|pva: Monitor the PV over Channel Access (default) or pvAccess,\n"
+    "            pipelined with a bounded queue (see pva_in.h)\n"
+    "  field=<path>: pvAccess field of the value, default 'value'; an NTTable\n"
+    "            column is value.<column>\n"
+    "  delta=0|1: 1 - do not write a value equal to the last one written,\n"
+    "            e.g. tables and lookup arrays monitored as waveforms\n"
+    "            (see delta.h). Default 0\n"
+    "  ado=<name>: Write the parameter of the ADO <name> instead of ADO_name.\n"
+    "            A PV can have several records, e.g. on different ADOs: it is\n"
+    "            subscribed once, the channel options come from its first record\n"
+    "Rule rows (PV column with '*' or '?', $1..$9 in the parameter columns):\n"
+    "  -L <file>: PV list, one name per line: the names without an explicit\n"
+    "            row are mapped by the first matching rule row (see rules.h)\n"
+    "Write queue options:\n"
+    "  -M <kB>:  Memory budget of the write queues, default %u kB\n"
+    "  -W <file>: Warm restart cache: hashes of the values written to ADO are\n"
+    "            kept in <file>; after a restart the first value of a channel\n"
+    "            is not written if ADO already holds it\n"
+    "  -G <sec>: Max wait of a write group for its missing members, default %g\n"
+    "  -B [<ado>=]<min>:<max>[,<dmin>:<dmax>]: Bounds of the ADO write batches:\n"
+    "            size in updates (default %u:%u) and flush delay in seconds\n"
+    "            (default %g:%g). Within them the batch grows while the writes\n"
+    "            fall behind and shrinks under light load. Can be repeated\n"
+    "Shared-memory table:\n"
+    "  -P <name>: Publish the latest value, timestamp, alarm and connection\n"
+    "            state of every channel in the POSIX shared memory <name>,\n"
+    "            e.g. /epics2ado, for local readers (see e2a_shm.h)\n"
+    "Control socket:\n"
+    "  -C <path>: Serve runtime commands on the UNIX-domain socket <path>:\n"
+    "            stats, pvs, pause, resume, rate, verb (see ctl.h), e.g.\n"
+    "            echo stats | socat - UNIX-CONNECT:<path>\n"
+    "Supervisor mode (see super.h):\n"
+    "  -j <n>[:<first>[-<last>]][,ado|ioc]: Split the map into <n> shards by\n"
+    "            ADO (default) or IOC (PV name up to the first ':') and bridge\n"
+    "            each shard in a worker process; run the shards <first>..<last>\n"
+    "            (default all) on this host. Crashed workers are restarted, the\n"
+    "            -C, -W and -P names of a worker get the suffix .<shard>\n"
+    "  -J <file>: Partition file shared by the hosts of the shards: written if\n"
+    "            it does not exist, followed otherwise\n"
+    "Thread placement (layout reported at startup, see place.h):\n"
+    "  -A <cpus>[:<prio>]: Pin the event loop thread (CA callbacks, queues,\n"
+    "            ADO writes) to the CPUs, e.g. 2 or 2,3 or 4-7, optionally\n"
+    "            with SCHED_FIFO priority <prio>\n"
+    "  -a <cpus>[:<prio>]: The same for the CA threads, applied once they\n"
+    "            connected and for new circuits every few seconds. Default: as -A\n"
+    "  -N <node>|local: Allocate the buffers on the NUMA node, 'local' - the\n"
+    "            node of the -A CPUs\n"
+    "Soak test (no CA connections, ADO writes go to a mock sink):\n"
+    "  -K <sec>[,<kB>]: Feed the channels of the map at maximum rate for <sec>\n"
+    "            seconds, fail if RSS or heap grow by more than <kB> (default\n"
+    "            %u) after the warm-up or if file descriptors leak\n"
+    "  -k <file>: Replay the events recorded with -o bin instead of synthetic ones\n"
+    "Benchmarks (no ADO name and map file needed):\n"
+    "  -X <file>: Time val2str, val2double, dbr2str, pv2param, map parsing and\n"
+    "            the ADO value construction, write JSON lines to <file>\n"
+    "            ('-': stdout) and exit (see bench.h)\n"
+    "Self-checks (no ADO name and map file needed):\n"
+    "  -T:       Check the fast paths of the value transforms against their\n"
+    "            bytecode, print the failures and exit (see check.h)\n"
+    "Monitor output:\n"
+    "  -o <fmt>: Print every monitor event: 'text' - camonitor style lines,\n"
+    "            'json' - one JSON object per line, 'bin' - binary records\n"
+    "            (see mon_out.h). Default 'none'\n"
     "Channel Access options:\n"
     "  -w <sec>: Wait time, specifies CA timeout, default is %f second(s)\n"
     "  -m <msk>: Specify CA event mask to use.  <msk> is any combination of\n"
@@ -64,7 +206,7 @@ void usage (const char* progname)
     "            'I' = incremental timestamps (time since last update, by channel)\n"
     "            'r', 'i' or 'I' require 's' or 'c' to select the time source\n"
     "Enum format:\n"
-    "  -n:       Print DBF_ENUM values as number (default is enum string)\n"
+    "  -n:       Forward DBF_ENUM values as number (default is enum string)\n"
     "Array values: Print number of elements, then list of values\n"
     "  Default:  Request and print all elements (dynamic arrays supported)\n"
     "  -# <num>: Request and print up to <num> elements\n"
@@ -74,7 +216,7 @@ void usage (const char* progname)
     "  -e <num>: Use %%e format, with a precision of <num> digits\n"
     "  -f <num>: Use %%f format, with a precision of <num> digits\n"
     "  -g <num>: Use %%g format, with a precision of <num> digits\n"
-    "  -s:       Get value as string (honors server-side precision)\n"
+    "  -s:       Forward value as string (honors server-side precision)\n"
     "  -lx:      Round to long integer and print as hex number\n"
     "  -lo:      Round to long integer and print as octal number\n"
     "  -lb:      Round to long integer and print as binary number\n"
@@ -87,7 +229,10 @@ void usage (const char* progname)
     "  -F <ofs>: Use <ofs> to separate fields in output\n"
     "\n"
     "Example: %s simple.test epics2ado_simple.csv\n"
-             , progname, DEFAULT_TIMEOUT, CA_PRIORITY_MAX, progname);
+             , progname, SCHED_NCLASS-1, SCHED_CA_PRIORITY_STEP,
+             SCHED_DEPTH, MAP_MAX_OUTS, SCHED_MEMORY_BUDGET, GROUP_TIMEOUT,
+             BATCH_MIN_SIZE, BATCH_MAX_SIZE, BATCH_MIN_DELAY, BATCH_MAX_DELAY, SOAK_ALLOWANCE,
+             DEFAULT_TIMEOUT, CA_PRIORITY_MAX, progname);
 }
 
 //'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
@@ -95,41 +240,151 @@ void usage (const char* progname)
 //
 #include <stdlib.h>
 
-#define MAXRECORDS 100
+#define MAXRECORDS 10000
+#define MAXRULES 1000 // maximum number of rule rows
 #define MINCOLS 3 // expected minimum number of columns
-#define MAXTOKENS  MAXRECORDS*MINCOLS
-#define MAXTOKENSIZE 100
+#define MAXCOLS 12 // maximum number of columns, including the key=value options
+#define MAXRECORDSIZE 256 // token storage per record, at most one line of the csv file
 
-#define VERB_INFO 1
-#define VERB_DEBUG 2
-#define VERB_DETAILED 4
 int gVerb = 1;
 
 // globals
-char *gpv2ado_map[MAXTOKENS]; // epics-to-ado map, filled by parse_epics2ado_csvmap
-                              // 3 elements per record: 0:epics_PVname, 1:flag(direction), 2:ado_param_name
+mapRec gmap[MAXRECORDS];      // epics-to-ado map, filled by parse_epics2ado_csvmap
+                              // record: 0:epics_PVname, 1:flag(direction), 2:ado_param_name, options
                               // the flag defines the data direction: three options: '>', '<', and 'x'
-char gstorage[MAXTOKENS*MAXTOKENSIZE];
-int gncols=0;
-int gnPvs=0;
+char gstorage[MAXRECORDS*MAXRECORDSIZE];
+mapRec gRules[MAXRULES];      // rule rows: the PV column has wildcards, see rules.h
+int gnRules=0;
+int gnRows=0;                 // map records
+int gnPvs=0;                  // channels, one per PV, bound to the first gnPvs map records
 char *gAdoName=NULL;
+adoSetBatchFunc *gAdoSetBatch=adoSetBatch;
+adoSetBatchFunc *gAdoSetGroup=adoSetGroup;
+adoDiscoverFunc *gAdoDiscover=adoDiscover;
+static pv *gPvs=NULL;         // channels, gPvs[n] is bound to gmap[n] and the records chained to it
+
+// parse_event_mask
+// convert the letters 'v' (value), 'a' (alarm), 'l' (log/archive), 'p' (property)
+// to the CA event mask, return 0 if a letter is not valid
+static unsigned long parse_event_mask(const char *letters)
+{
+  unsigned long mask = 0;
+  for (; *letters; letters++)
+    switch (*letters)
+    {
+    case 'v': mask |= DBE_VALUE; break;
+    case 'a': mask |= DBE_ALARM; break;
+    case 'l': mask |= DBE_LOG; break;
+    case 'p': mask |= DBE_PROPERTY; break;
+    default: return 0;
+    }
+  return mask;
+}
+
+// parse_map_option
+// interpret the optional key=value column of the map record
+// return 0 on success, 1 if the option is not recognized or invalid
+static int parse_map_option(mapRec *rec, char *option)
+{
+  char *val = strchr(option,'=');
+  if(val == NULL) return 1;
+  *val++ = '\0';
+  if(strcmp(option,"prio") == 0)
+  {
+    if(sscanf(val,"%i",&rec->prio) != 1) return 1;
+    if(rec->prio < 0 || rec->prio >= SCHED_NCLASS) return 1;
+  }
+  else if(strcmp(option,"ovf") == 0)
+  {
+    rec->ovf = sched_overflow_policy(val);
+    if(rec->ovf < 0) return 1;
+  }
+  else if(strcmp(option,"depth") == 0)
+  {
+    if(sscanf(val,"%i",&rec->depth) != 1 || rec->depth <= 0) return 1;
+  }
+  else if(strcmp(option,"mask") == 0)
+  {
+    rec->mask = parse_event_mask(val);
+    if(rec->mask == 0) return 1;
+  }
+  else if(strcmp(option,"nelm") == 0)
+  {
+    if(sscanf(val,"%lu",&rec->nelm) != 1) return 1;
+  }
+  else if(strcmp(option,"dyn") == 0)
+  {
+    if(sscanf(val,"%i",&rec->dyn) != 1 || (rec->dyn != 0 && rec->dyn != 1)) return 1;
+  }
+  else if(strcmp(option,"delta") == 0)
+  {
+    if(sscanf(val,"%i",&rec->delta) != 1 || (rec->delta != 0 && rec->delta != 1)) return 1;
+  }
+  else if(strcmp(option,"rate") == 0)
+  {
+    if(sscanf(val,"%lf",&rec->rate) != 1 || rec->rate < 0.) return 1;
+  }
+  else if(strcmp(option,"xf") == 0)
+  {
+    const char *err = NULL;
+    rec->xf = xf_compile(val,&err);
+    if(rec->xf == NULL) {printf("ERROR in transform '%s': %s\n",val,err); return 1;}
+    if(gVerb&VERB_DEBUG) printf("Transform of %s: %s\n",rec->pvName,xf_describe(rec->xf));
+  }
+  else if(strcmp(option,"src") == 0)
+  {
+    if(strcmp(val,"ca") == 0) rec->src = srcCA;
+    else if(strcmp(val,"pva") == 0) rec->src = srcPVA;
+    else return 1;
+  }
+  else if(strcmp(option,"field") == 0)
+  {
+    if(*val == '\0') return 1;
+    rec->field = val;
+  }
+  else if(strcmp(option,"ado") == 0)
+  {
+    if(*val == '\0') return 1;
+    rec->ado = val;
+  }
+  else if(strcmp(option,"grp") == 0)
+  {
+    if(group_join(val,&rec->grp,&rec->grpMember))
+      {printf("ERROR too many groups (%i) or members (%i) in group %s\n",GROUP_MAX,GROUP_MAX_MEMBERS,val); return 1;}
+  }
+  else if(strcmp(option,"red") == 0)
+  {
+    if(reduce_parse(val,&rec->red,&rec->redN)) return 1;
+  }
+  else if(strcmp(option,"out") == 0)
+  {
+    char *p, *save = NULL;
+    for(p = strtok_r(val,";",&save); p; p = strtok_r(NULL,";",&save))
+    {
+      if(rec->nOuts >= MAP_MAX_OUTS) return 1;
+      rec->outs[rec->nOuts++] = p;
+    }
+    if(rec->nOuts == 0) return 1;
+  }
+  else return 1;
+  return 0;
+}
 
 // parse_epics2ado_csvmap
-// read the csv file with epics-to-ado table and fill gpv2ado_map
+// read the csv file with epics-to-ado table and fill the map records
 int parse_epics2ado_csvmap(
   const char *filename,  //in:
   const int selectkey,   //in: select key for column[1]
                          // selectkey='>': select records for epics -> ado conversion
                          // selectkey='<': select records for ado -> epics conversion
                          // selectkey='x': select all records
-  int *ncols,            //out: number of columns in the table
-  char *tokens[],        //io: array for accepting the token pointers
-  const int max_tokens,  //in: size of array of token pointers
+  mapRec recs[],         //io: array for accepting the records
+  const int max_recs,    //in: size of array of records
   char *storage,         //io: storage for token strings
   const int storage_size //in: size of the storage
 )
 {
-  #define MAX_STRING_LENGTH 100
+  #define MAX_STRING_LENGTH 256
   FILE *pFile;
   char mystring [MAX_STRING_LENGTH];
   char *instring = NULL;
@@ -139,7 +394,6 @@ int parse_epics2ado_csvmap(
   int ii=0;
   int col=0;
   char *key = NULL;
-  *ncols = 0;
 
   pFile = fopen (filename,"r");
   if (pFile == NULL)
@@ -159,6 +413,7 @@ int parse_epics2ado_csvmap(
 
       //check if the field in the second column matches the key
       key = strchr(instring,',');
+      if(key == NULL) continue;
       if(key[1] != selectkey && selectkey != '*') //check if record should be dropped
         if(key[1] != 'x')
            if (!(key[1] != '.' && selectkey == 'x')) //
@@ -167,62 +422,375 @@ int parse_epics2ado_csvmap(
           continue;
         }
       if(gVerb&VERB_DEBUG) printf ("Splitting string \"%s\" into tokens:\n",instring);
+      if(ntoks >= max_recs) {printf("ERROR. too many records in epics2ado.csv\n"); exit(EXIT_FAILURE);}
+      memset(&recs[ntoks],0,sizeof(mapRec));
+      recs[ntoks].dyn = 1;
+      recs[ntoks].nextRow = -1;
       pch = strtok (instring," ,\"\n");
       col = 0;
       while (pch != NULL)
       {
-        if(ntoks >= max_tokens) {printf("ERROR. too many tokens in epics2ado.csv\n"); exit(EXIT_FAILURE);}
+        if(col >= MAXCOLS) {printf("ERROR. too many columns in the epics2ado table line %i\n",ii); exit(EXIT_FAILURE);}
         if(filled + strlen(pch) >= storage_size) {perror("ERROR. too little storage for epics2ado.csv\n"); exit(EXIT_FAILURE);}
 
-        tokens[ntoks] = storage + filled;
         //printf ("<%s>\n",pch);
         strcpy(storage+filled,pch);
+        switch(col)
+        {
+        case 0: recs[ntoks].pvName = storage+filled; break;
+        case 1: recs[ntoks].dir = pch[0]; break;
+        case 2: recs[ntoks].param = storage+filled; break;
+        default:
+          if(parse_map_option(&recs[ntoks],storage+filled))
+          {
+            printf("ERROR invalid option '%s' in the epics2ado table line %i\n",pch,ii);
+            exit(EXIT_FAILURE);
+          }
+        }
         filled += strlen(pch)+1;
-        ntoks++;
         pch = strtok (NULL, " ,\"\n");
         col++;
       }
-      if(ncols[0]==0) ncols[0] = col;
-      else if(ncols[0] != col)
+      if(col < MINCOLS)
+      {
+        printf("ERROR too few columns in the epics2ado table line %i, col %i\n",ii, col);
+        exit(EXIT_FAILURE);
+      }
+      if(recs[ntoks].nOuts && !recs[ntoks].red)
+      {
+        printf("ERROR out= without red= in the epics2ado table line %i\n",ii);
+        exit(EXIT_FAILURE);
+      }
+      if(recs[ntoks].delta && recs[ntoks].grp)  // a skipped member would hold the group
       {
-        printf("ERROR inconsistent number of columns in the epics2ado table line %i, col %i\n",ii, col);
+        printf("ERROR delta= with grp= in the epics2ado table line %i\n",ii);
         exit(EXIT_FAILURE);
       }
+      if(rules_is_pattern(recs[ntoks].pvName)) // rule row, expanded by expand_rules
+      {
+        if(recs[ntoks].grp) {printf("ERROR grp= in the rule row line %i\n",ii); exit(EXIT_FAILURE);}
+        if(gnRules >= MAXRULES || rules_add(recs[ntoks].pvName, MAXRECORDS+gnRules))
+          {printf("ERROR too many rule rows or wildcards in the epics2ado table line %i\n",ii); exit(EXIT_FAILURE);}
+        gRules[gnRules++] = recs[ntoks];
+        continue;
+      }
+      ntoks++;
   }
-  if(ncols[0]) ntoks /= ncols[0];
   if(gVerb&VERB_INFO) printf("Number of records selected: %i\n",ntoks);
-  //for(ii=0;ii<ntoks;ii++) printf("<%s>\n",tokens[ii]);
 
   fclose(pFile);
   return ntoks;
 }
 // pv2param
 // return the ado parameter name for the epics PV using conversion table
-char* pv2param(const char* pvname, char* table[], const int ncols, const int nrows)
+char* pv2param(const char* pvname, const mapRec table[], const int nrows)
 {
 	int ii;
 	char* nothing = "";
 	for (ii=0; ii<nrows; ii++)
 	{
-		if(strcmp(table[ii*ncols+0],pvname) == 0 ) return table[ii*ncols+2];
+		if(strcmp(table[ii].pvName,pvname) == 0 ) return table[ii].param;
 	}
 	return nothing;
 }
-// adoSetString defined in epics2ado.cxx
-// set ADO parameter to paramValue
-int adoSetString(const char* adoName, const char* paramName, const char* paramValue, const int type);
 
-// pv_changed - called in the EPICS event loop to react on PV change
-static void pv_changed(pv* pv)
+// expand_rules
+// add a map record for each PV of the list file which matches a rule row and
+// has no explicit row, the parameter names are substituted from the rule
+// return the new number of records
+static int expand_rules(const char *filename, mapRec recs[], int nrecs, const int max_recs)
+{
+  char line[MAX_STRING_LENGTH], buf[MAX_STRING_LENGTH];
+  char *name;
+  ruleMatch m;
+  int ii, id, k, unmatched = 0, expanded = 0;
+  FILE *pFile = fopen(filename,"r");
+
+  if(pFile == NULL) {perror(filename); exit(EXIT_FAILURE);}
+  for(ii=0; ii<nrecs; ii++) // explicit rows take precedence over the rules
+    if(rules_add(recs[ii].pvName, ii)) {printf("ERROR too many map records for the rules\n"); exit(EXIT_FAILURE);}
+  while(fgets(line, MAX_STRING_LENGTH, pFile) != NULL)
+  {
+    name = strtok(line," \t\r\n,\"");
+    if(name == NULL || name[0] == '#') continue;
+    id = rules_match(name, &m);
+    if(id < 0) unmatched++;
+    if(id < MAXRECORDS) continue; // no rule or an explicit row
+    if(nrecs >= max_recs) {printf("ERROR. too many records after expanding %s\n",filename); exit(EXIT_FAILURE);}
+    recs[nrecs] = gRules[id-MAXRECORDS];
+    recs[nrecs].pvName = strdup(name);
+    if(rules_expand(gRules[id-MAXRECORDS].param, name, &m, buf, sizeof(buf)))
+      {printf("ERROR expanding %s for %s\n",gRules[id-MAXRECORDS].param,name); exit(EXIT_FAILURE);}
+    recs[nrecs].param = strdup(buf);
+    if(recs[nrecs].ado)
+    {
+      if(rules_expand(gRules[id-MAXRECORDS].ado, name, &m, buf, sizeof(buf)))
+        {printf("ERROR expanding %s for %s\n",gRules[id-MAXRECORDS].ado,name); exit(EXIT_FAILURE);}
+      recs[nrecs].ado = strdup(buf);
+    }
+    for(k=0; k<recs[nrecs].nOuts; k++)
+    {
+      if(rules_expand(gRules[id-MAXRECORDS].outs[k], name, &m, buf, sizeof(buf)))
+        {printf("ERROR expanding %s for %s\n",gRules[id-MAXRECORDS].outs[k],name); exit(EXIT_FAILURE);}
+      recs[nrecs].outs[k] = strdup(buf);
+    }
+    if(gVerb&VERB_DEBUG) printf("Rule %s: %s -> %s\n",gRules[id-MAXRECORDS].pvName,name,recs[nrecs].param);
+    rules_add(name, nrecs); // a repeated name is an explicit row now
+    nrecs++;
+    expanded++;
+  }
+  fclose(pFile);
+  rules_free();
+  if(gVerb&VERB_INFO) printf("PV list %s: %i records from %i rules, %i PVs without rule\n",
+                             filename,expanded,gnRules,unmatched);
+  return nrecs;
+}
+
+// same_channel - the map records agree on the options of the subscription and the write queue
+static int same_channel(const mapRec *a, const mapRec *b)
+{
+  return a->prio == b->prio && a->ovf == b->ovf && a->depth == b->depth && a->mask == b->mask &&
+         a->nelm == b->nelm && a->dyn == b->dyn && a->rate == b->rate &&
+         a->red == b->red && a->redN == b->redN && a->src == b->src &&
+         (a->field && b->field ? strcmp(a->field, b->field) == 0 : a->field == b->field);
+}
+
+// bind_rows
+// order the map so that the first record of each PV comes first, in the map
+// order, followed by the further records of the PVs; the records of a PV are
+// chained by nextRow. Only the first ones get a channel: gPvs[n] is bound to
+// gmap[n] for n < number of channels, the returned value. The channel options
+// of the further records are taken from the first one
+static int bind_rows(mapRec recs[], const int nrecs)
+{
+  mapRec *sorted = malloc(nrecs*sizeof(mapRec));
+  int *first = malloc(nrecs*sizeof(int));  // record of the PV's channel, by map order
+  int *pos = malloc(nrecs*sizeof(int));    // new position of the record
+  const char *grpAdo[GROUP_MAX+1];
+  ruleMatch m;
+  int ii, nChan = 0, k;
+
+  if(!sorted || !first || !pos) {printf("ERROR. no memory for binding %i records\n",nrecs); exit(EXIT_FAILURE);}
+  for(ii=0; ii<nrecs; ii++) // a name is matched by its first record
+    if(rules_add(recs[ii].pvName, ii)) {printf("ERROR too many map records\n"); exit(EXIT_FAILURE);}
+  for(ii=0; ii<nrecs; ii++)
+  {
+    first[ii] = rules_match(recs[ii].pvName, &m);
+    if(first[ii] == ii) pos[ii] = nChan++;
+  }
+  rules_free();
+  k = nChan;
+  for(ii=0; ii<nrecs; ii++)
+    if(first[ii] != ii) pos[ii] = k++;
+  for(ii=0; ii<nrecs; ii++)
+  {
+    mapRec *rec = &sorted[pos[ii]], *chan = &sorted[pos[first[ii]]];
+    *rec = recs[ii];
+    rec->nextRow = -1;
+    if(first[ii] == ii) continue;
+    if(!same_channel(rec, chan))
+      printf("WARNING %s -> %s: channel options differ from the first record of the PV, ignored\n",
+             rec->pvName, rec->param);
+    rec->prio = chan->prio; rec->ovf = chan->ovf; rec->depth = chan->depth;
+    rec->mask = chan->mask; rec->nelm = chan->nelm; rec->dyn = chan->dyn;
+    rec->rate = chan->rate; rec->red = chan->red; rec->redN = chan->redN;
+    rec->src = chan->src; rec->field = chan->field;
+    while(chan->nextRow >= 0) chan = &sorted[chan->nextRow];
+    chan->nextRow = pos[ii];
+  }
+  memset(grpAdo, 0, sizeof(grpAdo));
+  for(ii=0; ii<nrecs; ii++) // a group is written with one Set
+  {
+    const char *ado = sorted[ii].ado ? sorted[ii].ado : gAdoName;
+    if(!sorted[ii].grp) continue;
+    if(grpAdo[sorted[ii].grp] && strcmp(grpAdo[sorted[ii].grp], ado))
+      {printf("ERROR %s -> %s: the records of a group must write to one ADO\n",sorted[ii].pvName,sorted[ii].param); exit(EXIT_FAILURE);}
+    grpAdo[sorted[ii].grp] = ado;
+  }
+  memcpy(recs, sorted, nrecs*sizeof(mapRec));
+  free(sorted);
+  free(first);
+  free(pos);
+  if((gVerb&VERB_INFO) && nChan < nrecs) printf("%i records bound to %i channels\n",nrecs,nChan);
+  return nChan;
+}
+
+static const char *gAdoTypeNames[] = {"unknown", "guess", "string", "int", "double"};
+
+// discover_param - query the type of the ADO parameter and cache it in the map record
+static void discover_param(mapRec *rec)
+{
+	const char *ado = rec->ado ? rec->ado : gAdoName;
+	rec->adoLength = 1;
+	rec->adoType = gAdoDiscover(ado, rec->param, &rec->adoLength);
+	if(gVerb&VERB_DEBUG) printf("ADO %s.%s: type %s, %lu element(s)\n",
+	                            ado, rec->param, gAdoTypeNames[rec->adoType], rec->adoLength);
+}
+
+// reduced_outs - writes of the segments after the first of the reduced value v to the out= parameters
+// return the number of writes stored in items
+static int reduced_outs(const mapRec *rec, const double *v, unsigned long nElems, unsigned long seg, adoItem items[])
+{
+	unsigned long start;
+	int k;
+
+	for(k = 0; k < rec->nOuts; k++)
+	{
+		adoItem *item = &items[k];
+		start = (k + 1)*seg;
+		if(start >= nElems) break;
+		item->param = rec->outs[k];
+		item->type = adoTypeDouble;
+		item->str = NULL;
+		item->cachedType = NULL;
+		item->count = nElems - start < seg ? nElems - start : seg;
+		item->num = v[start];
+		item->vec = item->count > 1 ? v + start : NULL;
+		item->stamp = 0;
+	}
+	return k;
+}
+
+/* Conversions of the queued value, made once for all map records of the PV */
+typedef struct pvConv
+{
+	pv    *pv;
+	char  *str;             // meta_val2str of the first element, NULL: not yet
+	int    strType;         // type returned by meta_val2str
+	double *base;           // elements as doubles (xf_input), shared, not transformed
+	unsigned long nBase;    // number of elements in base
+} pvConv;
+
+// conv_str - the value as string
+static const char *conv_str(pvConv *c, int *type)
+{
+	if(c->str == NULL)
+	{
+		c->strType = c->pv->dbrType;
+		c->str = meta_val2str(c->pv,0,&c->strType);
+	}
+	*type = c->strType;
+	return c->str;
+}
+
+// conv_doubles - the first n elements as doubles, in scratch if the record transforms them
+static double *conv_doubles(pvConv *c, const mapRec *rec, unsigned long n)
 {
-	// get changed PV
-	char *str = val2str(pv->value,pv->dbrType,0);;
-	int type = pv->dbrType;
-    //TODO/for (i=0; i<pv->nElems; ++i) {
-	if(gVerb&VERB_DETAILED) printf("PV %s changed to value='%s' (type=%i, count=%li)\n",pv->name, str, type, pv->nElems);
-    //print_time_val_sts(pv, reqElems);
+	static double *scratch = NULL;
+	static unsigned long size = 0;
+
+	if(n > c->nBase)
+	{
+		c->base = xf_input(c->pv->value, c->pv->dbrType, n);
+		if(c->base == NULL) return NULL;
+		c->nBase = n;
+	}
+	if(!rec->xf) return c->base;
+	if(n > size)
+	{
+		double *p = realloc(scratch, n*sizeof(double));
+		if(!p) return NULL;
+		scratch = p;
+		size = n;
+	}
+	memcpy(scratch, c->base, n*sizeof(double));
+	xf_apply(rec->xf, scratch, n);
+	return scratch;
+}
+
+// forward_row - write the converted value to the ADO parameters of one map record
+static void forward_row(int row, pvConv *c)
+{
+	mapRec *rec = &gmap[row];
+	pv *pv = c->pv;
+	adoItem items[GROUP_MAX_ITEMS], item;
+	int type = pv->dbrType, nItems = 1, ii;
+	const epicsTimeStamp *stamp = &((struct dbr_time_double *)pv->value)->stamp;
+	const char *ado = rec->ado ? rec->ado : gAdoName;
+	unsigned long seg = pv->nElems;     // elements for param, a reduced value is split with the out= parameters
+	double *v = NULL;
+	uint64_t h = 0;
+
+	if(rec->adoType == adoTypeUnknown)  // after a failed Set
+	{
+		warm_invalidate(row);
+		delta_invalidate(row);
+		discover_param(rec);
+	}
+	if(rec->red && rec->nOuts)
+	{
+		seg = pv->nElems/(1 + rec->nOuts);
+		if(seg == 0) seg = 1;
+	}
+	item.param = rec->param;
+	item.cachedType = &rec->adoType;
+	item.type = rec->adoType;
+	if(item.type == adoTypeGuess)
+		item.type = type == DBR_TIME_DOUBLE ? adoTypeDouble : adoTypeString;
+	item.count = 1;
+	item.vec = NULL;
+	item.str = NULL;
+	item.num = 0.;
+	item.stamp = 0;
+	if(item.type == adoTypeString && !rec->xf && !rec->nOuts)
+	{
+		item.str = conv_str(c, &type);
+		if(gVerb&VERB_DETAILED) printf("PV %s changed to value='%s' (type=%i, count=%li)\n",pv->name, item.str, type, pv->nElems);
+	}
+	else
+	{
+		// arrays go whole to array parameters, up to the ADO length
+		unsigned long n = rec->adoLength > 1 && item.type != adoTypeString ?
+		                  (seg < rec->adoLength ? seg : rec->adoLength) : 1;
+		v = conv_doubles(c, rec, rec->nOuts ? pv->nElems : n);
+		if(v == NULL) return;
+		item.num = v[0];
+		if(n > 1) {item.vec = v; item.count = n;}
+		if(item.type == adoTypeString)
+		{
+			static char numstr[32];
+			snprintf(numstr, sizeof(numstr), "%.15g", item.num);
+			item.str = numstr;
+		}
+		if(gVerb&VERB_DETAILED) printf("PV %s changed to value=%g (type=%i, count=%li)\n",pv->name, item.num, type, pv->nElems);
+	}
+	E2A_PROBE4(convert, (int)(pv - gPvs), row, item.type, item.count);
 	//update ADO
-	adoSetString(gAdoName, pv2param(pv->name,gpv2ado_map,gncols,gnPvs), str, type);
+	items[0] = item;
+	if(rec->nOuts) nItems += reduced_outs(rec, v, pv->nElems, seg, items + 1);
+	if(rec->dir == 'x')                 // drop the value the ADO mirrored back from the last write
+	{
+		h = warm_hash(nItems, items);
+		if(echo_repeat(row, h)) return; // ADO holds the value
+	}
+	if(rec->delta && (v ? delta_unchanged(row, v, rec->nOuts ? pv->nElems : item.count)
+	                    : delta_unchanged_str(row, item.str)))
+		return;                         // ADO holds the value
+	if(rec->dir == 'x') echo_written(row, h);
+	if(warm_skip(row, stamp, nItems, items)) return;  // ADO holds the value
+	if(rec->grp)
+	{
+		for(ii = 0; ii < nItems; ii++)  // the server timestamp, shared by the round
+			items[ii].stamp = stamp->secPastEpoch + POSIX_TIME_AT_EPICS_EPOCH;
+		group_put(ado, rec->grp, rec->grpMember, stamp, nItems, items);
+	}
+	else for(ii = 0; ii < nItems; ii++)
+		batch_add(ado, &items[ii]);
+}
+
+// pv_changed - called by the scheduler to forward the queued PV change to ADO,
+// to each map record of the PV; the writes copy the values, so the conversions are shared
+static void pv_changed(pv* pv)
+{
+	pvConv c;
+	int row;
+
+	c.pv = pv;
+	c.str = NULL;
+	c.base = NULL;
+	c.nBase = 0;
+	for(row = pv - gPvs; row >= 0; row = gmap[row].nextRow)
+		forward_row(row, &c);
 }
 //,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,
 
@@ -230,17 +798,49 @@ static void pv_changed(pv* pv)
 
 static unsigned long reqElems = 0;
 static unsigned long eventMask = DBE_VALUE | DBE_ALARM;   /* Event mask used */
-static int floatAsString = 0;                             /* Flag: fetch floats as string */
 static int nConn = 0;                                     /* Number of connected PVs */
 
 
 
+// pv_event - monitor update of the PV: print it if -o, reduce it if red= and queue it for the ADO writer
+static void pv_event(pv *pv, long type, unsigned long count, const void *dbr)
+{
+    const mapRec *rec = &gmap[pv - gPvs];
+
+    if (meta_hold(pv, type, count, dbr, pv_event))
+        return;                 /* the enum strings did not arrive yet */
+    E2A_PROBE4(event, (int)(pv - gPvs), ((const struct dbr_time_double *)dbr)->stamp.secPastEpoch,
+               ((const struct dbr_time_double *)dbr)->stamp.nsec, count);
+    shm_pub_update(pv, type, count, dbr);
+    if (gOutFormat != outNone)
+    {
+        pv->dbrType = type;
+        pv->nElems = count;
+        pv->value = (void *) dbr;    /* casting away const */
+        mon_out_event(pv, pv->reqElems);
+        pv->value = NULL;
+    }
+    if (rec->red)               /* Only the reduced array is queued */
+    {
+        unsigned long m;
+        const void *red = reduce_event(rec->red, rec->redN, type, count, dbr, &m);
+        if (red) {
+            type = DBR_TIME_DOUBLE;
+            count = m;
+            dbr = red;
+        }
+    }
+                                /* Queue for the ADO writer */
+    if (sched_enqueue(pv, type, count, dbr) && (gVerb&VERB_DETAILED))
+        printf("Update of %s lost on queue overflow\n", pv->name);
+}
+
 /*+**************************************************************************
  *
  * Function:	event_handler
  *
  * Description:	CA event_handler for request type callback
- * 		Prints the event data
+ * 		Queues the event data for the ADO writer, prints it if -o
  *
  * Arg(s) In:	args  -  event handler args (see CA manual)
  *
@@ -252,16 +852,31 @@ static void event_handler (evargs args)
 
     pv->status = args.status;
     if (args.status == ECA_NORMAL)
-    {
-        pv->dbrType = args.type;
-        pv->nElems = args.count;
-        pv->value = (void *) args.dbr;    /* casting away const */
+        pv_event(pv, args.type, args.count, args.dbr);
+}
 
-        pv_changed(pv);
-        fflush(stdout);
+// subscribe - create the CA monitor of the PV as set up by connection_handler
+static void subscribe(pv *ppv)
+{
+    ppv->status = ca_create_subscription(ppv->dbrType,
+                                        ppv->reqElems,
+                                        ppv->ch_id,
+                                        ppv->eventMask,
+                                        event_handler,
+                                        (void*)ppv,
+                                        &ppv->ev_id);
+}
 
-        pv->value = NULL;
+// pause_subscription - called by the scheduler to stop or restart the monitor
+// of a PV with 'block' overflow policy
+static void pause_subscription(pv *ppv, int pause)
+{
+    if (gmap[ppv - gPvs].src == srcPVA) pva_pause(ppv, pause);
+    else if (pause) {
+        if (ppv->ev_id) ca_clear_subscription(ppv->ev_id);
+        ppv->ev_id = NULL;
     }
+    else if (!ppv->ev_id) subscribe(ppv);
 }
 
 /*+**************************************************************************
@@ -279,6 +894,8 @@ static void connection_handler ( struct connection_handler_args args )
     pv *ppv = ( pv * ) ca_puser ( args.chid );
     if ( args.op == CA_OP_CONN_UP ) {
         nConn++;
+        E2A_PROBE2(connect, (int)(ppv - gPvs), 1);
+        shm_pub_connection(ppv, 1);
         if (!ppv->onceConnected) {
             ppv->onceConnected = 1;
                                 /* Set up pv structure */
@@ -286,40 +903,95 @@ static void connection_handler ( struct connection_handler_args args )
 
                                 /* Get natural type and array count */
             ppv->dbfType = ca_field_type(ppv->ch_id);
-            ppv->dbrType = dbf_type_to_DBR_TIME(ppv->dbfType); /* Use native type */
-            if (dbr_type_is_ENUM(ppv->dbrType))                /* Enums honour -n option */
-            {
-                if (enumAsNr) ppv->dbrType = DBR_TIME_INT;
-                else          ppv->dbrType = DBR_TIME_STRING;
-            }
-            else if (floatAsString &&
-                     (dbr_type_is_FLOAT(ppv->dbrType) || dbr_type_is_DOUBLE(ppv->dbrType)))
-            {
-                ppv->dbrType = DBR_TIME_STRING;
-            }
+            ppv->dbrType = dbf_type_to_DBR_TIME(ppv->dbfType); /* Use native type, */
+                                /* enums (-n) and floats (-s) are converted with the metadata */
                                 /* Set request count */
             ppv->nElems   = ca_element_count(ppv->ch_id);
-            ppv->reqElems = reqElems > ppv->nElems ? ppv->nElems : reqElems;
+            if (ppv->reqElems > ppv->nElems || (ppv->fullArray && ppv->reqElems == 0))
+                ppv->reqElems = ppv->nElems;
 
                                 /* Issue CA request */
                                 /* ---------------- */
-            /* install monitor once with first connect */
-            ppv->status = ca_create_subscription(ppv->dbrType,
-                                                ppv->reqElems,
-                                                ppv->ch_id,
-                                                eventMask,
-                                                event_handler,
-                                                (void*)ppv,
-                                                NULL);
+            /* install monitors once with first connect, metadata first */
+            if (meta_subscribe(ppv) != ECA_NORMAL)
+                fprintf(stderr, "Failed to subscribe to the properties of %s\n", ppv->name);
+            subscribe(ppv);
         }
     }
     else if ( args.op == CA_OP_CONN_DOWN ) {
         nConn--;
+        E2A_PROBE2(connect, (int)(ppv - gPvs), 0);
+        shm_pub_connection(ppv, 0);
         ppv->status = ECA_DISCONN;
         print_time_val_sts(ppv, reqElems);
     }
 }
 
+// pva_connection - connection handler of the pvAccess channels
+static void pva_connection(pv *ppv, int connected)
+{
+    E2A_PROBE2(connect, (int)(ppv - gPvs), connected);
+    shm_pub_connection(ppv, connected);
+    if (connected) {
+        nConn++;
+        ppv->onceConnected = 1;
+        ppv->status = ECA_NORMAL;
+    }
+    else {
+        nConn--;
+        ppv->status = ECA_DISCONN;
+        print_time_val_sts(ppv, reqElems);
+    }
+}
+
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Event loop hooks
+static int gCaReadable = 0;   // a CA fd became readable since the last ca_poll()
+
+static void ca_fd_readable(void *arg, int fd)
+{
+    gCaReadable = 1;
+}
+
+// ca_fd_registration - called by CA when it opens or closes a socket
+static void ca_fd_registration(void *arg, int fd, int opened)
+{
+    if (opened) reactor_add_fd(fd, ca_fd_readable, arg);
+    else        reactor_remove_fd(fd);
+}
+
+static void report_timer(void *arg, int fd)
+{
+    sched_report(stdout);
+    batch_report(stdout);
+    group_report(stdout);
+    warm_report(stdout);
+    echo_report(stdout);
+    delta_report(stdout);
+    pva_report(stdout);
+}
+
+// place_timer - give the CA placement to the threads of new circuits
+static void place_timer(void *arg, int fd)
+{
+    place_threads();
+}
+
+// loop_work - called by the reactor after each batch of events
+// process CA callbacks and forward the queued updates to ADO
+static int loop_work(void)
+{
+    if (gCaReadable)
+    {
+        gCaReadable = 0;
+        ca_poll();
+    }
+    sched_drain(SCHED_DRAIN_BUDGET);
+    batch_flush_due();
+    if (gOutFormat != outNone) mon_out_flush();
+    return sched_pending();
+}
+//,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,
 
 /*+**************************************************************************
  *
@@ -345,6 +1017,13 @@ int main (int argc, char *argv[])
     IntFormatT outType;         /* Output type */
 
     int opt;                    /* getopt() current option */
+    int placing = 0;            /* -A or -a given */
+    const char *ctlPath = NULL; /* Control socket (-C option) */
+    const char *warmPath = NULL; /* Warm restart cache (-W option) */
+    const char *benchPath = NULL; /* Benchmark output (-X option) */
+    const char *listPath = NULL; /* PV list for the rule rows (-L option) */
+    const char *shmName = NULL; /* Shared-memory table (-P option) */
+    const char *partPath = NULL; /* Partition file (-J option) */
     int digits = 0;             /* getopt() no. of float digits */
 
     //int nPvs;                   /* Number of PVs */
@@ -352,7 +1031,7 @@ int main (int argc, char *argv[])
 
     LINE_BUFFER(stdout);        /* Configure stdout buffering */
 
-    while ((opt = getopt(argc, argv, ":nhm:sSe:f:g:l:#:0:w:t:p:F:v:")) != -1) {
+    while ((opt = getopt(argc, argv, ":nhTm:sSe:f:g:l:#:0:w:t:p:F:v:M:B:G:W:A:a:N:X:L:P:j:J:o:K:k:C:")) != -1) {
         switch (opt) {
         case 'h':               /* Print usage */
             usage(argv[0]);
@@ -406,22 +1085,12 @@ int main (int argc, char *argv[])
             if (caPriority > CA_PRIORITY_MAX) caPriority = CA_PRIORITY_MAX;
             break;
         case 'm':               /* Select CA event mask */
-            eventMask = 0;
+            eventMask = parse_event_mask(optarg);
+            if (eventMask == 0)
             {
-                int i = 0;
-                char c, err = 0;
-                while ((c = optarg[i++]) && !err)
-                    switch (c) {
-                    case 'v': eventMask |= DBE_VALUE; break;
-                    case 'a': eventMask |= DBE_ALARM; break;
-                    case 'l': eventMask |= DBE_LOG; break;
-                    case 'p': eventMask |= DBE_PROPERTY; break;
-                        default :
-                            fprintf(stderr, "Invalid argument '%s' "
-                                    "for option '-m' - ignored.\n", optarg);
-                            eventMask = DBE_VALUE | DBE_ALARM;
-                            err = 1;
-                    }
+                fprintf(stderr, "Invalid argument '%s' "
+                        "for option '-m' - ignored.\n", optarg);
+                eventMask = DBE_VALUE | DBE_ALARM;
             }
             break;
         case 's':               /* Select string dbr for floating type data */
@@ -466,6 +1135,90 @@ int main (int argc, char *argv[])
             fieldSeparator = (char) *optarg;
             break;
         case 'v': gVerb = atoi(optarg); fprintf(stderr,"verbosity set to %i\n",gVerb); break;
+        case 'o':               /* Monitor output format */
+            {
+                int fmt = mon_out_format(optarg);
+                if (fmt < 0)
+                    fprintf(stderr, "Invalid argument '%s' "
+                            "for option '-o' - ignored.\n", optarg);
+                else
+                    gOutFormat = fmt;
+            }
+            break;
+        case 'K':               /* Soak test: duration[,allowed growth kB] */
+            if (sscanf(optarg, "%lf,%lu", &gSoakDuration, &gSoakAllowance) < 1
+                || gSoakDuration <= 0.)
+            {
+                fprintf(stderr, "'%s' is not a valid soak test duration "
+                        "- ignored. ('camonitor -h' for help.)\n", optarg);
+                gSoakDuration = 0.;
+            }
+            break;
+        case 'k':               /* Soak test: replay file */
+            gSoakReplay = optarg;
+            break;
+        case 'M':               /* Memory budget of the write queues */
+            {
+                unsigned long kb;
+                if (sscanf(optarg,"%lu", &kb) != 1 || kb == 0)
+                    fprintf(stderr, "'%s' is not a valid memory budget "
+                            "- ignored. ('camonitor -h' for help.)\n", optarg);
+                else
+                    gSchedBudget = kb*1024UL;
+            }
+            break;
+        case 'C':               /* Control socket */
+            ctlPath = optarg;
+            break;
+        case 'A':               /* Placement of the event loop thread */
+        case 'a':               /* Placement of the CA threads */
+            if (place_parse(opt == 'A' ? PLACE_LOOP : PLACE_CA, optarg))
+            {
+                fprintf(stderr, "'%s' is not a valid CPU list[:priority] "
+                        "- ignored. ('camonitor -h' for help.)\n", optarg);
+            }
+            else placing = 1;
+            break;
+        case 'N':               /* NUMA node of the buffers */
+            if (place_parse_node(optarg))
+                fprintf(stderr, "'%s' is not a valid NUMA node "
+                        "- ignored. ('camonitor -h' for help.)\n", optarg);
+            break;
+        case 'P':               /* Shared-memory table of the latest values */
+            shmName = optarg;
+            break;
+        case 'j':               /* Supervisor mode: shards */
+            if (super_parse(optarg))
+                fprintf(stderr, "'%s' is not a valid shard specification "
+                        "- ignored. ('camonitor -h' for help.)\n", optarg);
+            break;
+        case 'J':               /* Supervisor mode: partition file */
+            partPath = optarg;
+            break;
+        case 'L':               /* PV list for the rule rows */
+            listPath = optarg;
+            break;
+        case 'T':               /* Self-checks */
+            return check_run();
+        case 'X':               /* Benchmarks */
+            benchPath = optarg;
+            break;
+        case 'W':               /* Warm restart cache */
+            warmPath = optarg;
+            break;
+        case 'G':               /* Timeout of the write groups */
+            if (sscanf(optarg, "%lf", &gGroupTimeout) != 1 || gGroupTimeout <= 0.)
+            {
+                fprintf(stderr, "'%s' is not a valid group timeout "
+                        "- ignored. ('camonitor -h' for help.)\n", optarg);
+                gGroupTimeout = GROUP_TIMEOUT;
+            }
+            break;
+        case 'B':               /* Bounds of the ADO write batches */
+            if (batch_config(optarg))
+                fprintf(stderr, "'%s' is not a valid batch specification "
+                        "- ignored. ('camonitor -h' for help.)\n", optarg);
+            break;
         case '?':
             fprintf(stderr,
                     "Unrecognized option: '-%c'. ('camonitor -h' for help.)\n",
@@ -481,6 +1234,9 @@ int main (int argc, char *argv[])
             return 1;
         }
     }
+    mon_out_stdout();           /* nothing written to stdout yet */
+    if (benchPath)
+        return bench_run(benchPath);
     if(argc - optind != 2)
     {
         fprintf(stderr, "Two arguments expected: ADO name and csv map file\n");
@@ -490,35 +1246,140 @@ int main (int argc, char *argv[])
     //'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
     // select records of type 'epics < ado'
     printf("ADO: %s, map file: %s\n",gAdoName,argv[optind+1]);
-    gnPvs = parse_epics2ado_csvmap(argv[optind+1],'>',&gncols,gpv2ado_map,MAXTOKENS,gstorage,MAXTOKENS*MAXTOKENSIZE);
-    if(gnPvs==0) {fprintf(stderr, "No PV's in the map file with '>' direction.\n"); return 1;}
-
-                                /* Start up Channel Access */
+    gnRows = parse_epics2ado_csvmap(argv[optind+1],'>',gmap,MAXRECORDS,gstorage,MAXRECORDS*MAXRECORDSIZE);
+    if(listPath) gnRows = expand_rules(listPath,gmap,gnRows,MAXRECORDS);
+    else if(gnRules) fprintf(stderr, "%i rule rows ignored, they need a PV list (-L).\n",gnRules);
+    if(gnRows==0) {fprintf(stderr, "No PV's in the map file with '>' direction.\n"); return 1;}
+    if(gSuperShards)            /* supervisor: returns only in the workers */
+    {
+        int shard = super_run(gmap,&gnRows,gAdoName,partPath,&returncode);
+        if(shard < 0) return returncode;
+        printf("Shard %i: %i map records\n",shard,gnRows);
+        ctlPath = super_path(ctlPath,shard);
+        warmPath = super_path(warmPath,shard);
+        shmName = super_path(shmName,shard);
+    }
+    gnPvs = bind_rows(gmap,gnRows);
 
+                                /* Start up Channel Access, the CA threads
+                                   are placed once they exist */
+    if (place_memory() || place_apply(PLACE_LOOP))
+        return 1;
     result = ca_context_create(ca_disable_preemptive_callback);
     if (result != ECA_NORMAL) {
         fprintf(stderr, "CA error %s occurred while trying "
                 "to start channel access.\n", ca_message(result));
         return 1;
+    }
+    if (gVerb&VERB_INFO && !placing) place_report(stdout);
+    if (reactor_init() ||
+        ca_add_fd_registration(ca_fd_registration, NULL) != ECA_NORMAL)
+    {
+        fprintf(stderr, "Failed to set up the event loop.\n");
+        return 1;
     }
                                 /* Allocate PV structure array */
 
-    pvs = calloc (gnPvs, sizeof(pv));
+    if (posix_memalign ((void **)&pvs, PV_CACHE_LINE, gnPvs*sizeof(pv)))
+        pvs = NULL;
+    else
+        memset (pvs, 0, gnPvs*sizeof(pv));
     if (!pvs)
     {
         fprintf(stderr, "Memory allocation for channel structures failed.\n");
         return 1;
+    }
+    if (sched_init(pvs, gnPvs, pv_changed))
+    {
+        fprintf(stderr, "Memory allocation for write queues failed.\n");
+        return 1;
+    }
+    gPvs = pvs;
+    sched_set_pause_handler(pause_subscription);
+    if (gOutFormat != outNone && mon_out_init(pvs, gnPvs))
+    {
+        fprintf(stderr, "Memory allocation for monitor output failed.\n");
+        return 1;
     }
                                 /* Connect channels */
 
-                                      /* Copy PV names from command line */
+                                      /* Copy PV names from the map */
     for (n = 0; n < gnPvs; n++)
     {
-        pvs[n].name   = gpv2ado_map[n*gncols + 0];
-        if(gVerb&VERB_INFO) printf("Monitor epics PV: %s, update ADO: %s.%s\n",pvs[n].name,gAdoName,pv2param(pvs[n].name,gpv2ado_map,gncols,gnPvs));
+        pvs[n].name   = gmap[n].pvName;
+        pvs[n].priority = sched_ca_priority(gmap[n].prio);
+        sched_set_class(&pvs[n], gmap[n].prio);
+        sched_set_overflow(&pvs[n], gmap[n].ovf, gmap[n].depth);
+        pvs[n].eventMask = gmap[n].mask ? gmap[n].mask : eventMask;
+        pvs[n].reqElems = gmap[n].nelm ? gmap[n].nelm : reqElems;
+        pvs[n].fullArray = !gmap[n].dyn;
+        sched_set_rate(&pvs[n], gmap[n].rate);
+        if(gVerb&VERB_INFO)
+        {
+            int row;
+            printf("Monitor epics PV: %s, class %i, update ADO:",pvs[n].name,gmap[n].prio);
+            for(row = n; row >= 0; row = gmap[row].nextRow)
+                printf(" %s.%s",gmap[row].ado ? gmap[row].ado : gAdoName,gmap[row].param);
+            printf("\n");
+        }
+    }
+    if (ctlPath && ctl_init(ctlPath, pvs, gmap, gnPvs))
+    {
+        fprintf(stderr, "Failed to create the control socket.\n");
+        return 1;
+    }
+    if (super_worker_start(pvs, gnPvs))
+    {
+        fprintf(stderr, "Failed to start the counters of the worker.\n");
+        return 1;
+    }
+    if (warmPath && warm_open(warmPath, gmap, gnRows))
+    {
+        fprintf(stderr, "Failed to open the warm restart cache.\n");
+        return 1;
+    }
+    if (shmName && shm_pub_open(shmName, pvs, gnPvs))
+    {
+        fprintf(stderr, "Failed to create the shared-memory table.\n");
+        return 1;
+    }
+    for (n = 0; n < gnRows && gmap[n].dir != 'x'; n++) ;
+    if (n < gnRows && echo_init(gnRows))    /* bidirectional records */
+    {
+        fprintf(stderr, "Memory allocation for repeat suppression failed.\n");
+        return 1;
+    }
+    for (n = 0; n < gnRows && !gmap[n].delta; n++) ;
+    if (n < gnRows && delta_init(gnRows))   /* delta mode records */
+    {
+        fprintf(stderr, "Memory allocation for the delta copies failed.\n");
+        return 1;
     }
-                                      /* Create CA connections */
-    returncode = create_pvs(pvs, gnPvs, connection_handler);
+    if (gSoakDuration > 0.)
+    {
+        gAdoSetBatch = soak_ado_set;
+        gAdoSetGroup = soak_ado_set;
+        gAdoDiscover = soak_ado_discover;
+        result = soak_run(pvs, gnPvs, pv_event, loop_work);
+        warm_report(stdout);
+        echo_report(stdout);
+        delta_report(stdout);
+        delta_close();
+        shm_pub_close();
+        warm_close();
+        ctl_close();
+        return result;
+    }
+                                      /* Discover the ADO parameter types */
+    for (n = 0; n < gnRows; n++)
+        discover_param(&gmap[n]);
+                                      /* Create CA connections and pvAccess monitors */
+    for (n = 0; n < gnPvs && gmap[n].src != srcPVA; n++) ;
+    if (n < gnPvs && pva_init(pv_event, pva_connection))
+        return 1;
+    for (n = 0; n < gnPvs; n++)
+        returncode |= gmap[n].src == srcPVA ? pva_subscribe(&pvs[n], gmap[n].field) :
+                                              create_pvs(&pvs[n], 1, connection_handler);
     if ( returncode ) {
         return returncode;
     }
@@ -529,10 +1390,26 @@ int main (int argc, char *argv[])
         if (!pvs[n].onceConnected)
             print_time_val_sts(&pvs[n], reqElems);
     }
+                                /* Place the CA threads of the circuits, now
+                                   and for those which connect later */
+    if (placing)
+    {
+        if (place_threads() < 0)
+            return 1;
+        if (gVerb&VERB_INFO) place_report(stdout);
+        reactor_add_timer(PLACE_PERIOD, PLACE_PERIOD, place_timer, NULL);
+    }
 
-                                /* Read and print data forever */
+                                /* Forward data to ADO forever */
     printf("Event loop started...\n");
-    ca_pend_event(0);
+    if (gVerb&VERB_DEBUG)
+        reactor_add_timer(SCHED_REPORT_PERIOD, SCHED_REPORT_PERIOD, report_timer, NULL);
+    result = reactor_run(loop_work);
+    pva_close();
+    delta_close();
+    shm_pub_close();
+    warm_close();
+    ctl_close();
 
                                 /* Shut down Channel Access */
     ca_context_destroy();
@@ -0,0 +1,249 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Self-checks of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Value transforms: specialized loops against the bytecode.
+ * version v02 2026-10-19. Statistics of the waveform reduction.
+ * version v03 2026-10-19. Map rules: matching, precedence, substitution.
+ * version v04 2026-10-19. NaN values of the transforms.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <cadef.h>
+
+#include "xf.h"
+#include "reduce.h"
+#include "rules.h"
+#include "check.h"
+
+static int gFailed = 0, gChecked = 0;
+
+/* Equal, or both NaN, or within the rounding of a refolded a*x+b */
+static int same (double a, double b)
+{
+    if (a != a || b != b) return a != a && b != b;
+    return a == b || fabs(a - b) <= 1e-12*(fabs(a) + fabs(b));
+}
+
+static void fail (const char *what, const char *expr, double x, double got, double want)
+{
+    printf("check %s '%s' failed: x=%.17g, got %.17g, expected %.17g\n", what, expr, x, got, want);
+    gFailed++;
+}
+
+//''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Value transforms
+
+/* Known results */
+static const struct { const char *expr; double x, want; } gXfValues[] = {
+    {"max(min(x;5);10)",    0.,   10.},
+    {"max(min(x;5);10)",    20.,  10.},
+    {"min(max(x;10);5)",    0.,   5.},
+    {"clamp(x;0;100)",      -3.,  0.},
+    {"clamp(x;0;100)",      300., 100.},
+    {"clamp(x;10;5)",       0.,   10.},
+    {"clamp(x;10;5)",       20.,  5.},
+    {"min(3;x)",            7.,   3.},
+    {"int(x)",              -2.7, -2.},
+    {"round(x)",            -2.5, -3.},
+    {"round(x)",            2.5,  3.},
+    {"(x>>4)&255",          4096.+37*16, 37.},
+    {"x<<70",               1.,   0.},
+    {"x>>64",               -8.,  -1.},
+    {"x>>-1",               8.,   0.},
+    {"x<<62",               3.,   -4611686018427387904.},
+    {"x&1",                 1e300, 1.},
+    {"int(x)",              1e300, 1e300},
+    {"x*0.001+273.15",      1000., 274.15},
+    {"min(max(x;0);10)",    NAN,  NAN},             /* NaN passes the bounds */
+    {"max(x;3)",            NAN,  NAN},
+    {"min(3;x)",            NAN,  NAN},
+    {"clamp(x;0;100)",      NAN,  NAN},
+    {"int(x*2)",            NAN,  NAN},
+};
+
+/* Programs checked against their bytecode */
+static const char *gXfExprs[] = {
+    "x", "x*0.001+273.15", "2*(x+1)", "-x/4", "10-x*3",
+    "clamp(x;0;100)", "clamp(2*x+1;-5;5)", "clamp(x;10;5)",
+    "max(min(x;5);10)", "min(max(x;10);5)", "min(max(x;-10);10)", "max(x;3)", "min(3;x)",
+    "max(min(max(x;-50);50);0)", "int(x*0.3)", "round(x/7)", "int(clamp(x*0.5;-20;20))",
+    "round(min(x;100))", "(x>>4)&255", "abs(x)-sqrt(abs(x))", "x<<70", "x*x", NULL
+};
+
+static void check_xf (void)
+{
+    double in[CHECK_ELEMS], spec[CHECK_ELEMS], code[CHECK_ELEMS];
+    const char *err;
+    xfProg *prog;
+    int ii, jj;
+
+    for (ii = 0; ii < (int)(sizeof(gXfValues)/sizeof(gXfValues[0])); ii++)
+    {
+        double got;
+        prog = xf_compile(gXfValues[ii].expr, &err);
+        gChecked++;
+        if (!prog) {
+            printf("check xf '%s' failed: %s\n", gXfValues[ii].expr, err);
+            gFailed++;
+            continue;
+        }
+        got = xf_eval(prog, gXfValues[ii].x);
+        if (!same(got, gXfValues[ii].want)) fail("xf value", gXfValues[ii].expr, gXfValues[ii].x, got, gXfValues[ii].want);
+        got = xf_eval_code(prog, gXfValues[ii].x);
+        if (!same(got, gXfValues[ii].want)) fail("xf bytecode", gXfValues[ii].expr, gXfValues[ii].x, got, gXfValues[ii].want);
+        free(prog);
+    }
+    for (ii = 0; ii < CHECK_ELEMS; ii++)      /* both signs, fractions, ties of round, NaN */
+        in[ii] = ii % 97 == 0 ? NAN : (ii - CHECK_ELEMS/2)*0.25 + (ii % 7 == 0 ? 0.5 : 0.);
+    for (ii = 0; gXfExprs[ii]; ii++)
+    {
+        prog = xf_compile(gXfExprs[ii], &err);
+        gChecked++;
+        if (!prog) {
+            printf("check xf '%s' failed: %s\n", gXfExprs[ii], err);
+            gFailed++;
+            continue;
+        }
+        memcpy(spec, in, sizeof(in));
+        memcpy(code, in, sizeof(in));
+        xf_apply(prog, spec, CHECK_ELEMS);
+        xf_apply_code(prog, code, CHECK_ELEMS);
+        for (jj = 0; jj < CHECK_ELEMS; jj++)
+        {
+            double ref = xf_eval_code(prog, in[jj]);
+            if (!same(xf_eval(prog, in[jj]), ref)) {
+                fail("xf scalar", gXfExprs[ii], in[jj], xf_eval(prog, in[jj]), ref);
+                break;
+            }
+            if (!same(spec[jj], ref)) {
+                fail("xf array", gXfExprs[ii], in[jj], spec[jj], ref);
+                break;
+            }
+            if (!same(code[jj], ref)) {
+                fail("xf block", gXfExprs[ii], in[jj], code[jj], ref);
+                break;
+            }
+        }
+        free(prog);
+    }
+}
+
+//''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Waveform reduction
+
+/* Statistics of a small spread on a large offset, against the exact values */
+static const struct { double offset, spread; } gStatsCases[] = {
+    {0., 1.}, {1e3, 0.5}, {1e9, 1.}, {-3e12, 0.01},
+};
+
+static void check_reduce (void)
+{
+    struct dbr_time_double *dbr = calloc(1, dbr_size_n(DBR_TIME_DOUBLE, CHECK_ELEMS));
+    const double *res;
+    unsigned long m;
+    int ii, jj;
+
+    if (!dbr) return;
+    for (ii = 0; ii < (int)(sizeof(gStatsCases)/sizeof(gStatsCases[0])); ii++)
+    {
+        double off = gStatsCases[ii].offset, spread = gStatsCases[ii].spread;
+        double *v = &dbr->value;
+        for (jj = 0; jj < CHECK_ELEMS; jj++)  /* mean off, deviation spread */
+            v[jj] = off + (jj % 2 ? spread : -spread);
+        spread = (v[1] - v[0])/2;           /* as represented */
+        gChecked++;
+        res = reduce_event(redStats, 1, DBR_TIME_DOUBLE, CHECK_ELEMS, dbr, &m);
+        if (!res) {
+            printf("check reduce stats failed: no result\n");
+            gFailed++;
+            continue;
+        }
+        res = &((const struct dbr_time_double *)res)->value;
+        if (fabs(res[0] - off) > 1e-15*fabs(off)) fail("stats mean", "stats", off, res[0], off);
+        else if (fabs(res[4] - spread) > 1e-6*spread) fail("stats std", "stats", off, res[4], spread);
+    }
+    free(dbr);
+}
+
+//''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Map rules
+
+/* Patterns, added with their index as id */
+static const char *gRulePatterns[] = {
+    "IOC:BPM*:X", "IOC:BPM1*:X", "IOC:*:*", "IOC:BPM12:X", "?OC:*", "A*B*C*D*E*F*G*H*Z",
+    "*a*a*a*a*a*a*a*a*b", "S$:*", NULL
+};
+
+/* Names, the id of the matching pattern, a template and its expansion */
+static const struct { const char *name; int id; const char *templ, *want; } gRuleCases[] = {
+    {"IOC:BPM7:X",   0, "bpm.$1:xM",       "bpm.7:xM"},
+    {"IOC:BPM12:X",  0, "$0/$1",           "IOC:BPM12:X/12"},  /* lowest id, not the literal */
+    {"IOC:BPM:X",    0, "[$1]",            "[]"},              /* '*' matches nothing too */
+    {"IOC:BPMa:Y",   2, "$2.$1",           "Y.BPMa"},
+    {"IOC:BPMa:X:Y", 2, "$1|$2",           "BPMa|X:Y"},        /* the first '*' matches the least */
+    {"JOC:x",        4, "$1-$2 $$",        "J-x $"},
+    {"IOC",          -1, NULL, NULL},
+    {"ABCDEFGHZ",    5, "$8$1",            ""},
+    {"AxxBxxCxxDxxExxFxxGxxHxxZ", 5, "$1$8", "xxxx"},
+    {"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaac", -1, NULL, NULL},
+    {"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaab", 6, "$1|$9", "|aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"},
+    {"S$:v",         7, "$1$9",            NULL},              /* $9 without capture */
+};
+
+static void check_rules (void)
+{
+    ruleMatch m;
+    char out[256];
+    int ii, id;
+
+    for (ii = 0; gRulePatterns[ii]; ii++)
+        if (rules_add(gRulePatterns[ii], ii)) {
+            printf("check rules '%s' failed: not added\n", gRulePatterns[ii]);
+            gFailed++;
+        }
+    for (ii = 0; ii < (int)(sizeof(gRuleCases)/sizeof(gRuleCases[0])); ii++)
+    {
+        gChecked++;
+        id = rules_match(gRuleCases[ii].name, &m);
+        if (id != gRuleCases[ii].id) {
+            printf("check rules '%s' failed: pattern %i, expected %i\n", gRuleCases[ii].name, id, gRuleCases[ii].id);
+            gFailed++;
+            continue;
+        }
+        if (id < 0 || !gRuleCases[ii].templ) continue;
+        if (rules_expand(gRuleCases[ii].templ, gRuleCases[ii].name, &m, out, sizeof(out))) {
+            if (gRuleCases[ii].want) {
+                printf("check rules '%s' failed: '%s' not expanded\n", gRuleCases[ii].name, gRuleCases[ii].templ);
+                gFailed++;
+            }
+        }
+        else if (!gRuleCases[ii].want || strcmp(out, gRuleCases[ii].want) != 0) {
+            printf("check rules '%s' failed: '%s' expanded to '%s', expected '%s'\n", gRuleCases[ii].name,
+                   gRuleCases[ii].templ, out, gRuleCases[ii].want ? gRuleCases[ii].want : "an error");
+            gFailed++;
+        }
+    }
+    rules_free();
+}
+
+/*+**************************************************************************
+ *
+ * Function:	check_run
+ *
+ * Description:	Run the self-checks, print the failures and a summary
+ *
+ * Return(s):	0 - all passed, 1 - a check failed
+ *
+ **************************************************************************-*/
+
+int check_run (void)
+{
+    check_xf();
+    check_reduce();
+    check_rules();
+    printf("%i checks, %i failed\n", gChecked, gFailed);
+    return gFailed != 0;
+}
@@ -0,0 +1,22 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Self-checks of the epics to ado bridge (-T option)
+ *
+ * Table driven checks of the stages whose fast paths must agree with a
+ * plain reference:
+ *   xf     the specialized scale/clamp/cast loops of the value transforms
+ *          against their bytecode, scalar and array, and known results
+ *   reduce the mean and standard deviation of the stats reduction for a
+ *          small spread on a large offset
+ *   rules  matching of the map rule patterns, lowest id precedence, $n
+ *          substitution, and patterns with many stars on long names
+ * Each failure is printed; the exit code is 1 if any check failed.
+ */
+
+#ifndef INCLcheckh
+#define INCLcheckh
+
+#define CHECK_ELEMS 1000            /* Elements of the array checks */
+
+extern int check_run (void);
+
+#endif /* ifndef INCLcheckh */
@@ -0,0 +1,362 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Runtime control socket of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Stats, channel state, pause/resume, rate, verbosity.
+ * version v02 2026-10-19. Group statistics.
+ * version v03 2026-10-19. Echo statistics.
+ * version v04 2026-10-19. pvAccess channels.
+ * version v05 2026-10-19. Delta statistics.
+ * version v06 2026-10-19. Unsent answers kept until writable, socket file checked and mode set.
+ * version v07 2026-10-19. Sent part of the unsent answers dropped before appending.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "ado_batch.h"
+#include "ado_group.h"
+#include "echo.h"
+#include "delta.h"
+#include "pva_in.h"
+#include "reactor.h"
+#include "ctl.h"
+
+/* One connection */
+typedef struct ctlClient
+{
+    int  fd;                        // -1: free slot
+    int  len;                       // bytes in line
+    char line[CTL_LINE_SIZE];
+    char *out;                      // unsent answer, NULL: none
+    size_t outLen, outOff;          // its length, bytes sent
+    int  quit;                      // close when the answer is sent
+} ctlClient;
+
+static const char *gPath = NULL;
+static int gListenFd = -1;
+static ctlClient gClients[CTL_MAX_CLIENTS];
+static pv *gCtlPvs = NULL;
+static const mapRec *gCtlMap = NULL;
+static int gCtlNPvs = 0;
+static double gStart = 0., gLastStats = 0.;
+static unsigned long gLastEvents = 0, gLastWritten = 0;
+
+static void client_close (ctlClient *c)
+{
+    reactor_remove_fd(c->fd);
+    close(c->fd);
+    c->fd = -1;
+    free(c->out);
+    c->out = NULL;
+    c->outLen = c->outOff = 0;
+}
+
+/* Send what the socket takes of the unsent answer, close the connection on error or when done with quit */
+static void client_flush (ctlClient *c)
+{
+    while (c->outOff < c->outLen)
+    {
+        ssize_t n = send(c->fd, c->out + c->outOff, c->outLen - c->outOff, MSG_NOSIGNAL|MSG_DONTWAIT);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && errno == EAGAIN) {
+            reactor_want_write(c->fd, 1);
+            return;
+        }
+        if (n <= 0) {
+            client_close(c);
+            return;
+        }
+        c->outOff += n;
+    }
+    free(c->out);
+    c->out = NULL;
+    c->outLen = c->outOff = 0;
+    reactor_want_write(c->fd, 0);
+    if (c->quit) client_close(c);
+}
+
+/* CA channels without ch_id are pvAccess channels (src=pva) */
+static int is_connected (const pv *ppv)
+{
+    return ppv->ch_id ? ca_state(ppv->ch_id) == cs_conn : pva_connected(ppv);
+}
+
+/* Apply the function to the channels matching the pattern, return their number */
+static int for_matching (const char *pattern, void (*fn)(pv *, double), double arg)
+{
+    int n, matched = 0;
+    for (n = 0; n < gCtlNPvs; n++)
+        if (fnmatch(pattern, gCtlPvs[n].name, 0) == 0) {
+            fn(&gCtlPvs[n], arg);
+            matched++;
+        }
+    return matched;
+}
+
+static void do_pause (pv *ppv, double arg)  { sched_hold(ppv, 1); }
+static void do_resume (pv *ppv, double arg) { sched_hold(ppv, 0); }
+static void do_rate (pv *ppv, double arg)   { sched_set_rate(ppv, arg); }
+
+static void cmd_stats (FILE *out)
+{
+    double now = sched_now(), up = now - gStart, dt = now - gLastStats;
+    unsigned long events = 0, written = 0;
+    int n, connected = 0;
+    schedFlowInfo fi;
+
+    for (n = 0; n < gCtlNPvs; n++)
+    {
+        sched_flow_info(&gCtlPvs[n], &fi);
+        events += fi.events;
+        written += fi.written;
+        connected += is_connected(&gCtlPvs[n]);
+    }
+    fprintf(out, "uptime %.1f s, channels %i, connected %i\n", up, gCtlNPvs, connected);
+    fprintf(out, "events %lu (%.1f/s), written %lu (%.1f/s); last %.1f s: %.1f/s, %.1f/s\n",
+            events, events/up, written, written/up, dt,
+            (events - gLastEvents)/dt, (written - gLastWritten)/dt);
+    gLastStats = now;
+    gLastEvents = events;
+    gLastWritten = written;
+    sched_report(out);
+    batch_report(out);
+    group_report(out);
+    echo_report(out);
+    delta_report(out);
+    pva_report(out);
+}
+
+static void cmd_pvs (FILE *out, const char *pattern)
+{
+    double now = sched_now();
+    schedFlowInfo fi;
+    int n;
+
+    for (n = 0; n < gCtlNPvs; n++)
+    {
+        pv *ppv = &gCtlPvs[n];
+        if (pattern && fnmatch(pattern, ppv->name, 0) != 0) continue;
+        sched_flow_info(ppv, &fi);
+        fprintf(out, "%s -> %s: %s, ", ppv->name, gCtlMap[n].param,
+                is_connected(ppv) ? "connected" : "disconnected");
+        if (fi.tLastEvent > 0.) fprintf(out, "last %.3f s ago", now - fi.tLastEvent);
+        else                    fprintf(out, "no update");
+        fprintf(out, ", events %lu, written %lu, dropped %lu, queue %i/%i %s, class %i",
+                fi.events, fi.written, fi.dropped, fi.depth, fi.maxDepth,
+                gOverflowNames[fi.policy], fi.cls);
+        if (fi.rate > 0.) fprintf(out, ", rate %g Hz", fi.rate);
+        if (fi.held) fprintf(out, ", paused");
+        if (fi.paused) fprintf(out, ", blocked");
+        fprintf(out, "\n");
+    }
+}
+
+/* Execute the command line, the answer goes to out, return the error or NULL */
+static const char *ctl_execute (char *line, FILE *out, int *quit)
+{
+    char *cmd = strtok(line, " \t\r");
+    char *arg1 = strtok(NULL, " \t\r");
+    char *arg2 = strtok(NULL, " \t\r");
+    double rate;
+
+    if (!cmd) return NULL;
+    if (strcmp(cmd, "help") == 0)
+        fprintf(out, "stats | pvs [<glob>] | pause <glob> | resume <glob> | "
+                "rate <glob> <hz> | verb <mask> | quit\n");
+    else if (strcmp(cmd, "stats") == 0) cmd_stats(out);
+    else if (strcmp(cmd, "pvs") == 0) cmd_pvs(out, arg1);
+    else if (strcmp(cmd, "pause") == 0 || strcmp(cmd, "resume") == 0) {
+        if (!arg1) return "pattern expected";
+        if (!for_matching(arg1, cmd[0] == 'p' ? do_pause : do_resume, 0.))
+            return "no matching PV";
+    }
+    else if (strcmp(cmd, "rate") == 0) {
+        if (!arg1 || !arg2 || sscanf(arg2, "%lf", &rate) != 1 || rate < 0.)
+            return "pattern and rate expected";
+        if (!for_matching(arg1, do_rate, rate)) return "no matching PV";
+    }
+    else if (strcmp(cmd, "verb") == 0) {
+        if (!arg1) return "mask expected";
+        gVerb = atoi(arg1);
+    }
+    else if (strcmp(cmd, "quit") == 0) *quit = 1;
+    else return "unknown command, try help";
+    return NULL;
+}
+
+/* Answer one command, queue the answer behind the unsent one */
+static void ctl_answer (ctlClient *c)
+{
+    char *buf = NULL;
+    size_t len = 0;
+    const char *err;
+    FILE *out = open_memstream(&buf, &len);
+
+    if (!out) {
+        client_close(c);
+        return;
+    }
+    if (gVerb&VERB_DEBUG) printf("Control command: %s\n", c->line);
+    err = ctl_execute(c->line, out, &c->quit);
+    if (err) fprintf(out, "error: %s\n", err);
+    else     fprintf(out, "ok\n");
+    fclose(out);
+    if (c->out)                         /* behind the unsent answer */
+    {
+        size_t unsent = c->outLen - c->outOff;
+        char *p;
+
+        memmove(c->out, c->out + c->outOff, unsent);    /* drop the sent part */
+        c->outLen = unsent;
+        c->outOff = 0;
+        p = unsent + len > CTL_MAX_PENDING ? NULL : realloc(c->out, unsent + len);
+        if (!p) {
+            free(buf);
+            client_close(c);
+            return;
+        }
+        memcpy(p + unsent, buf, len);
+        free(buf);
+        c->out = p;
+        c->outLen += len;
+        return;
+    }
+    c->out = buf;
+    c->outLen = len;
+    c->outOff = 0;
+    client_flush(c);
+}
+
+/* Readable, or writable with an unsent answer */
+static void ctl_readable (void *arg, int fd)
+{
+    ctlClient *c = arg;
+    char buf[CTL_LINE_SIZE];
+    ssize_t n, ii;
+
+    if (c->out) {
+        client_flush(c);
+        if (c->fd < 0 || c->quit) return;   /* no more commands after quit */
+    }
+    n = recv(fd, buf, sizeof(buf), MSG_DONTWAIT);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    if (n <= 0) {
+        client_close(c);
+        return;
+    }
+    for (ii = 0; ii < n && c->fd >= 0 && !c->quit; ii++)
+    {
+        if (buf[ii] != '\n') {
+            if (c->len < CTL_LINE_SIZE-1) c->line[c->len++] = buf[ii];
+            continue;
+        }
+        c->line[c->len] = '\0';
+        c->len = 0;
+        ctl_answer(c);
+    }
+}
+
+static void ctl_accept (void *arg, int fd)
+{
+    int cfd = accept(fd, NULL, NULL);
+    int ii;
+
+    if (cfd < 0) return;
+    for (ii = 0; ii < CTL_MAX_CLIENTS; ii++)
+        if (gClients[ii].fd < 0) break;
+    if (ii == CTL_MAX_CLIENTS || reactor_add_fd(cfd, ctl_readable, &gClients[ii])) {
+        close(cfd);
+        return;
+    }
+    gClients[ii].fd = cfd;
+    gClients[ii].len = 0;
+    gClients[ii].quit = 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	ctl_init
+ *
+ * Description:	Create the control socket and serve it from the event loop
+ *
+ * Arg(s) In:	path  -  File name of the socket, an old socket is replaced
+ *              pvs   -  Pointer to an array of pv structures
+ *              map   -  Map records of the channels, map[n] for pvs[n]
+ *              nPvs  -  Number of elements in the pvs array
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int ctl_init (const char *path, pv *pvs, const mapRec *map, int nPvs)
+{
+    struct sockaddr_un addr;
+    struct stat st;
+    mode_t mask;
+    int ii, rc;
+
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Control socket path too long: %s\n", path);
+        return 1;
+    }
+    gListenFd = socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+    if (gListenFd < 0) {
+        perror("socket");
+        return 1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if (lstat(path, &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode)) {
+            fprintf(stderr, "Control socket %s: file exists and is not a socket\n", path);
+            close(gListenFd);
+            return 1;
+        }
+        unlink(path);
+    }
+    mask = umask(0777 & ~CTL_MODE);     /* no window with wider permissions */
+    rc = bind(gListenFd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(mask);
+    if (rc < 0 || chmod(path, CTL_MODE) < 0 ||
+        listen(gListenFd, CTL_MAX_CLIENTS) < 0) {
+        perror(path);
+        close(gListenFd);
+        return 1;
+    }
+    for (ii = 0; ii < CTL_MAX_CLIENTS; ii++) {
+        gClients[ii].fd = -1;
+        gClients[ii].out = NULL;
+        gClients[ii].outLen = gClients[ii].outOff = 0;
+    }
+    gPath = path;
+    gCtlPvs = pvs;
+    gCtlMap = map;
+    gCtlNPvs = nPvs;
+    gStart = gLastStats = sched_now();
+    return reactor_add_fd(gListenFd, ctl_accept, NULL);
+}
+
+void ctl_close (void)
+{
+    int ii;
+    if (gListenFd < 0) return;
+    for (ii = 0; ii < CTL_MAX_CLIENTS; ii++)
+        if (gClients[ii].fd >= 0) client_close(&gClients[ii]);
+    reactor_remove_fd(gListenFd);
+    close(gListenFd);
+    gListenFd = -1;
+    unlink(gPath);
+}
@@ -0,0 +1,34 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Runtime control socket of the epics to ado bridge (-C option)
+ *
+ * A UNIX-domain stream socket served from the event loop. Clients send one
+ * command per line and get the answer followed by a line "ok" or
+ * "error: <reason>", e.g. with  socat - UNIX-CONNECT:<path>
+ *   help                  list of the commands
+ *   stats                 global throughput, queue and batch statistics
+ *   pvs [<glob>]          state of the channels: connection, age of the
+ *                         last update, counters, queue depth, rate limit
+ *   pause <glob>          stop the subscriptions of the matching channels
+ *   resume <glob>         restart them
+ *   rate <glob> <hz>      limit the ADO writes of the channels, 0: no limit
+ *   verb <mask>           set the verbosity mask (-v)
+ *   quit                  close the connection
+ * <glob> is a shell pattern matched against the PV names. An answer which
+ * does not fit the socket buffer is kept and sent when the client reads,
+ * up to CTL_MAX_PENDING bytes; the client which lets more pile up is
+ * dropped. The socket is created with mode CTL_MODE, owner and group; an
+ * old socket file of the path is replaced, any other file is not touched.
+ */
+
+#ifndef INCLctlh
+#define INCLctlh
+
+#define CTL_MAX_CLIENTS 4           /* Max simultaneous connections */
+#define CTL_LINE_SIZE 256           /* Max length of a command line */
+#define CTL_MAX_PENDING (4 << 20)   /* Max unsent answer bytes per client */
+#define CTL_MODE 0660               /* Permissions of the socket */
+
+extern int ctl_init (const char *path, pv *pvs, const mapRec *map, int nPvs);
+extern void ctl_close (void);
+
+#endif /* ifndef INCLctlh */
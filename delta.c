@@ -0,0 +1,162 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Delta mode of the map records
+ *
+ * version v01 2026-10-19. Unchanged values not written, changed elements counted.
+ * version v02 2026-10-19. String values, copies dropped after a failed write.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "epics2ado.h"
+#include "delta.h"
+
+/* Value last forwarded by a map record */
+typedef struct deltaCopy
+{
+    double *v;
+    unsigned long n;                // elements in v, 0: no copy
+    unsigned long size;             // elements allocated
+    int   str;                      // v holds a string
+} deltaCopy;
+
+static deltaCopy *gCopies = NULL;   // per map record
+static int gNRecs = 0;
+static unsigned long gCompared = 0, gSkipped = 0;
+static unsigned long long gElems = 0, gChanged = 0;
+
+// delta_init - allocate the copies, 0 - success, 1 - no memory
+int delta_init (int nRecs)
+{
+    gCopies = calloc(nRecs, sizeof(deltaCopy));
+    gNRecs = nRecs;
+    return gCopies == NULL;
+}
+
+/* Number of elements which differ, bitwise */
+static unsigned long count_changed (const double *a, const double *b, unsigned long n)
+{
+    unsigned long ii, changed = 0;
+    uint64_t x, y;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        memcpy(&x, &a[ii], sizeof(x));
+        memcpy(&y, &b[ii], sizeof(y));
+        changed += x != y;
+    }
+    return changed;
+}
+
+/* copy_size - room for n elements in the copy, 0 - success, 1 - no memory, no copy */
+static int copy_size (deltaCopy *c, unsigned long n)
+{
+    double *p;
+
+    if (n <= c->size) return 0;
+    p = realloc(c->v, n*sizeof(double));
+    if (!p) {
+        c->n = 0;
+        return 1;
+    }
+    c->v = p;
+    c->size = n;
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	delta_unchanged
+ *
+ * Description:	Compare the value with the last one forwarded by the record,
+ *              keep it if it changed
+ *
+ * Arg(s) In:	index  -  Map record
+ *              v      -  Converted value
+ *              n      -  Number of elements
+ *
+ * Return(s):	1 - unchanged, do not write it; 0 - write it
+ *
+ **************************************************************************-*/
+
+int delta_unchanged (int index, const double *v, unsigned long n)
+{
+    deltaCopy *c;
+
+    if (!gCopies) return 0;
+    c = &gCopies[index];
+    gCompared++;
+    gElems += n;
+    if (!c->str && c->n == n && memcmp(c->v, v, n*sizeof(double)) == 0) {
+        gSkipped++;
+        return 1;
+    }
+    if (!c->str && c->n == n) gChanged += count_changed(c->v, v, n);
+    else                      gChanged += n;
+    if (copy_size(c, n)) return 0;
+    memcpy(c->v, v, n*sizeof(double));
+    c->n = n;
+    c->str = 0;
+    return 0;
+}
+
+// delta_unchanged_str - delta_unchanged of a string value, one element
+int delta_unchanged_str (int index, const char *s)
+{
+    size_t len = strlen(s) + 1;
+    unsigned long n = (len + sizeof(double) - 1)/sizeof(double);
+    deltaCopy *c;
+
+    if (!gCopies) return 0;
+    c = &gCopies[index];
+    gCompared++;
+    gElems++;
+    if (c->str && c->n == n && memcmp(c->v, s, len) == 0) {
+        gSkipped++;
+        return 1;
+    }
+    gChanged++;
+    if (copy_size(c, n)) return 0;
+    memcpy(c->v, s, len);
+    c->n = n;
+    c->str = 1;
+    return 0;
+}
+
+// delta_invalidate - the next value of the record is written
+void delta_invalidate (int index)
+{
+    if (gCopies) gCopies[index].n = 0;
+}
+
+// delta_written - drop the copies of the records whose writes failed, called
+// after each Set as warm_written() is: with failures reported, the items
+// without a type cache (out= parameters) are taken as failed too
+void delta_written (int n, const adoItem items[], int failed)
+{
+    int ii;
+
+    if (!gCopies || !failed) return;
+    for (ii = 0; ii < n; ii++)
+    {
+        const adoItem *it = &items[ii];
+        if (it->cachedType && *it->cachedType != adoTypeUnknown) continue;
+        if (it->row >= 0 && it->row < gNRecs) gCopies[it->row].n = 0;
+    }
+}
+
+void delta_report (FILE *stream)
+{
+    if (gCopies) fprintf(stream, "delta: records %i, compared %lu, unchanged %lu, changed elements %llu of %llu\n",
+                         gNRecs, gCompared, gSkipped, gChanged, gElems);
+}
+
+void delta_close (void)
+{
+    int ii;
+    if (!gCopies) return;
+    for (ii = 0; ii < gNRecs; ii++) free(gCopies[ii].v);
+    free(gCopies);
+    gCopies = NULL;
+}
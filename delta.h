@@ -0,0 +1,26 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Delta mode of the map records (delta=1)
+ *
+ * A slowly changing table or lookup array monitored as a waveform arrives
+ * whole with every update, although few or none of its elements changed.
+ * With delta=1 the converted value of the record (after xf= and red=) is
+ * compared with the copy last forwarded to ADO, and an unchanged value is
+ * not written. A string value is compared as a string. The comparison is
+ * a memcmp(), vectorized by the C library; the copy is taken only when the
+ * value changed. It is dropped when a write of the record fails, also of
+ * an out= parameter, so the next update is written. The changed elements
+ * of the changed arrays are counted.
+ */
+
+#ifndef INCLdeltah
+#define INCLdeltah
+
+extern int  delta_init (int nRecs);
+extern int  delta_unchanged (int index, const double *v, unsigned long n);
+extern int  delta_unchanged_str (int index, const char *s);
+extern void delta_invalidate (int index);
+extern void delta_written (int n, const adoItem items[], int failed);
+extern void delta_report (FILE *stream);
+extern void delta_close (void);
+
+#endif /* ifndef INCLdeltah */
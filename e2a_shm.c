@@ -0,0 +1,142 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Reader library of the shared-memory latest-value table
+ *
+ * version v01 2026-10-19. Open, find, seqlock read.
+ */
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "e2a_shm.h"
+
+#define E2A_SHM_MAX_RETRIES 100000  /* reads overtaken by the writer before giving up */
+
+struct e2aShm
+{
+    const e2aShmHeader *hdr;
+    const char *slots;
+    size_t size;
+};
+
+static const e2aShmSlot *slot_of (const e2aShm *t, int index)
+{
+    return (const e2aShmSlot *)(t->slots + (size_t)index*t->hdr->slotSize);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	e2a_shm_open
+ *
+ * Description:	Map the table read-only
+ *
+ * Arg(s) In:	name  -  Shared-memory object, as given to -P, e.g. /epics2ado
+ *
+ * Return(s):	The table, NULL if it does not exist or is not valid
+ *
+ **************************************************************************-*/
+
+e2aShm *e2a_shm_open (const char *name)
+{
+    e2aShm *t;
+    struct stat st;
+    void *p;
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(e2aShmHeader)) {
+        close(fd);
+        return NULL;
+    }
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return NULL;
+    t = malloc(sizeof(*t));
+    if (t) {
+        t->hdr = p;
+        t->slots = (const char *)p + sizeof(e2aShmHeader);
+        t->size = st.st_size;
+    }
+    if (!t || t->hdr->magic != E2A_SHM_MAGIC || t->hdr->version != E2A_SHM_VERSION
+        || t->hdr->slotSize != sizeof(e2aShmSlot)
+        || t->size < sizeof(e2aShmHeader) + (size_t)t->hdr->nSlots*t->hdr->slotSize)
+    {
+        munmap(p, st.st_size);
+        free(t);
+        return NULL;
+    }
+    return t;
+}
+
+int e2a_shm_count (const e2aShm *t)
+{
+    return t->hdr->nSlots;
+}
+
+// e2a_shm_find - index of the PV's slot, -1: not in the table
+int e2a_shm_find (const e2aShm *t, const char *pvName)
+{
+    int ii;
+    for (ii = 0; ii < (int)t->hdr->nSlots; ii++)
+        if (strncmp(slot_of(t, ii)->name, pvName, E2A_SHM_NAME_SIZE) == 0) return ii;
+    return -1;
+}
+
+const char *e2a_shm_name (const e2aShm *t, int index)
+{
+    return slot_of(t, index)->name;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	e2a_shm_read
+ *
+ * Description:	Copy the value of the slot, consistent with itself
+ *
+ * Arg(s) In:	t      -  Table
+ *              index  -  Slot, from e2a_shm_find
+ *
+ * Arg(s) Out:	v      -  Value
+ *
+ * Return(s):	0 - success, 1 - bad index or the writer kept overtaking
+ *
+ **************************************************************************-*/
+
+int e2a_shm_read (const e2aShm *t, int index, e2aShmValue *v)
+{
+    const e2aShmSlot *s;
+    uint32_t seq0, seq1;
+    int ii;
+
+    if (index < 0 || index >= (int)t->hdr->nSlots) return 1;
+    s = slot_of(t, index);
+    for (ii = 0; ii < E2A_SHM_MAX_RETRIES; ii++)
+    {
+        seq0 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        if (seq0 & 1) continue;             /* being written */
+        memcpy(v, (const void *)&s->v, sizeof(*v));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq1 = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+        if (seq0 == seq1) return 0;
+    }
+    return 1;
+}
+
+// e2a_shm_stale - the bridge removed the table or died, open the new one
+int e2a_shm_stale (const e2aShm *t)
+{
+    return __atomic_load_n(&t->hdr->closed, __ATOMIC_ACQUIRE) != 0
+           || (kill(t->hdr->pid, 0) < 0 && errno == ESRCH);
+}
+
+void e2a_shm_close (e2aShm *t)
+{
+    if (!t) return;
+    munmap((void *)t->hdr, t->size);
+    free(t);
+}
@@ -0,0 +1,88 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Shared-memory latest-value table of the epics to ado bridge (-P option)
+ *
+ * The bridge publishes the latest value, server timestamp, alarm state and
+ * connection state of every channel into a POSIX shared-memory object, one
+ * slot per channel. Processes on the same host read it without syscalls,
+ * locks or CA connections of their own.
+ * Each slot is guarded by a sequence lock: the bridge (the only writer)
+ * makes seq odd, updates the slot and makes it even again; a reader copies
+ * the slot and retries if seq was odd or changed meanwhile. The writer never
+ * waits for the readers.
+ * This header and e2a_shm.c are the reader library, they do not depend on
+ * EPICS. Usage:
+ *   e2aShm *t = e2a_shm_open("/epics2ado");
+ *   int i = e2a_shm_find(t, "test:ai1");     // once, the slots do not move
+ *   e2aShmValue v;
+ *   if (e2a_shm_read(t, i, &v) == 0) printf("%g %s\n", v.value[0], v.str);
+ *   e2a_shm_close(t);
+ * When the bridge restarts it creates a new table, e2a_shm_stale() tells
+ * the readers of the old one to open it again.
+ */
+
+#ifndef INCLe2a_shmh
+#define INCLe2a_shmh
+
+#include <stdint.h>
+
+#define E2A_SHM_MAGIC 0x4d534132    /* "2ASM" */
+#define E2A_SHM_VERSION 1
+#define E2A_SHM_NAME_SIZE 64        /* PV name, truncated */
+#define E2A_SHM_STRING_SIZE 40      /* String or enum text (MAX_STRING_SIZE) */
+#define E2A_SHM_MAX_ELEMS 64        /* Elements of an array kept as doubles */
+
+/* Table header, followed by nSlots slots of slotSize bytes */
+typedef struct e2aShmHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nSlots;
+    uint32_t slotSize;
+    int32_t  pid;                   // bridge process
+    uint32_t closed;                // 1: the bridge removed the table
+} e2aShmHeader;
+
+/* The value of a slot, as copied out by e2a_shm_read */
+typedef struct e2aShmValue
+{
+    int32_t  dbrType;               // DBR_TIME_* type of the update, -1: no update yet
+    int16_t  status;                // alarm status
+    int16_t  severity;              // alarm severity
+    uint32_t secPastEpoch;          // server timestamp, EPICS epoch (1990)
+    uint32_t nsec;
+    uint32_t connected;             // 1: channel connected
+    uint32_t count;                 // elements of the update
+    uint32_t nValues;               // elements in value, <= E2A_SHM_MAX_ELEMS
+    uint64_t updates;               // number of updates since the bridge started
+    char     str[E2A_SHM_STRING_SIZE]; // first element of strings and enums as text, else empty
+    double   value[E2A_SHM_MAX_ELEMS]; // elements as doubles, 0 for strings
+} e2aShmValue;
+
+/* One slot per channel, on its own cache lines */
+typedef struct e2aShmSlot
+{
+    uint32_t seq;                   // sequence lock, odd while being written
+    uint32_t pad;
+    char     name[E2A_SHM_NAME_SIZE]; // set when the table is created
+    e2aShmValue v;
+} __attribute__((aligned(64))) e2aShmSlot;
+
+typedef struct e2aShm e2aShm;       /* Opened table, see e2a_shm.c */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern e2aShm *e2a_shm_open (const char *name);
+extern int  e2a_shm_count (const e2aShm *t);
+extern int  e2a_shm_find (const e2aShm *t, const char *pvName);
+extern const char *e2a_shm_name (const e2aShm *t, int index);
+extern int  e2a_shm_read (const e2aShm *t, int index, e2aShmValue *v);
+extern int  e2a_shm_stale (const e2aShm *t);
+extern void e2a_shm_close (e2aShm *t);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef INCLe2a_shmh */
@@ -0,0 +1,97 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Repeat suppression of the bidirectional ('x') map records
+ *
+ * version v01 2026-10-19. Repeats of the last ADO write dropped within ECHO_WINDOW, by value hash.
+ * version v02 2026-10-19. One slot per record, the bridge writes only EPICS to ADO.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "echo.h"
+
+/* Last ADO write of the record */
+typedef struct echoSlot
+{
+    uint64_t hash;                  // hash of the written value
+    unsigned long gen;              // write generation, counts the writes
+    unsigned long ackGen;           // generation whose echo came back or was given up
+    double time;                    // time of the write, sched_now()
+} echoSlot;
+
+static echoSlot *gSlots = NULL;     // per map record
+static int gNRecs = 0;
+static unsigned long gDropped = 0, gExpired = 0;
+
+// echo_init - allocate the slots, 0 - success, 1 - no memory
+int echo_init (int nRecs)
+{
+    gSlots = calloc(nRecs, sizeof(echoSlot));
+    gNRecs = nRecs;
+    return gSlots == NULL;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	echo_written
+ *
+ * Description:	Record a write of the bridge to ADO, the next update of the
+ *              record is compared with it
+ *
+ * Arg(s) In:	index  -  Map record
+ *              hash   -  warm_hash of the written value
+ *
+ **************************************************************************-*/
+
+void echo_written (int index, uint64_t hash)
+{
+    echoSlot *s;
+
+    if (!gSlots) return;
+    s = &gSlots[index];
+    s->hash = hash;
+    s->gen++;
+    s->time = sched_now();
+}
+
+/*+**************************************************************************
+ *
+ * Function:	echo_repeat
+ *
+ * Description:	Check the first update after a write against it
+ *
+ * Arg(s) In:	index  -  Map record
+ *              hash   -  warm_hash of the update
+ *
+ * Return(s):	1 - the update repeats the last write, drop it;
+ *              0 - forward it
+ *
+ **************************************************************************-*/
+
+int echo_repeat (int index, uint64_t hash)
+{
+    echoSlot *s;
+
+    if (!gSlots) return 0;
+    s = &gSlots[index];
+    if (s->ackGen == s->gen) return 0;      /* no write pending */
+    s->ackGen = s->gen;
+    if (sched_now() - s->time > ECHO_WINDOW) {
+        gExpired++;
+        return 0;
+    }
+    if (s->hash != hash) return 0;
+    gDropped++;
+    if (gVerb&VERB_DETAILED) printf("Repeat of the ADO write of record %i dropped\n", index);
+    return 1;
+}
+
+void echo_report (FILE *stream)
+{
+    if (gSlots) fprintf(stream, "echo: records %i, repeats of ADO writes dropped %lu, given up %lu\n",
+                        gNRecs, gDropped, gExpired);
+}
@@ -0,0 +1,28 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Repeat suppression of the bidirectional ('x') map records
+ *
+ * The bridge writes EPICS -> ADO only. The ADO of an 'x' row may mirror the
+ * parameter back to the PV, whose monitor then delivers the value the bridge
+ * has just written; written again, it would bounce forever. Per map record
+ * the hash of the last written value and a write generation are kept. The
+ * first update after a write is compared with it: with the same hash and
+ * within ECHO_WINDOW it is a repeat of the write and is dropped. This is
+ * deduplication against the last write, not origin tracking: an independent
+ * write of the same value to the PV within the window is dropped too, which
+ * loses nothing, ADO holds that value. Any other update ends the wait.
+ * The values are compared as the writes of the record (see warm_hash).
+ */
+
+#ifndef INCLechoh
+#define INCLechoh
+
+#include <stdint.h>
+
+#define ECHO_WINDOW 2.              /* Max delay of a repeat, s */
+
+extern int  echo_init (int nRecs);
+extern void echo_written (int index, uint64_t hash);
+extern int  echo_repeat (int index, uint64_t hash);
+extern void echo_report (FILE *stream);
+
+#endif /* ifndef INCLechoh */
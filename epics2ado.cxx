@@ -6,155 +6,163 @@
  * version v04 2016-07-15 by &RA. value type transferred to adoSetString
  * version v05 2016-07-15 by &RA. Better printing.
  * version v06 2016-08-01 by &RA. TIMESTAMPING.
+ * version v07 2026-10-19. AdoIf created once per ADO, adoSetBatch.
+ * version v08 2026-10-19. adoDiscover, Value constructed for the ADO parameter type.
+ * version v09 2026-10-19. Array parameters.
+ * version v10 2026-10-19. adoSetGroup: multi-parameter Set.
+ * version v11 2026-10-19. adoMakeValues.
+ * version v12 2026-10-19. adoSetBatch: one multi-parameter Set, per parameter statuses.
+ * version v13 2026-10-19. Single parameter setters and the SetAsync draft removed.
+ * version v14 2026-10-19. adoSetGroup: per parameter statuses; timestamp of the item.
  */
-/*TODO.
- * The function is not tuned for performance, although it is not CPU hungry.
- * The new AdoIf is constructed on each call to adoSetString. Surprisingly, it
- * does not cause the memory growth on repetitive calls.
- * It is probably make sense to avoid the re-creating of the AdoIf.
- */
+#include <map>
+#include <string>
+#include <vector>
 #include "adoIf/adoIf.hxx"
 #include "rhicError/rhicError.h"
+#include "epics2ado.h"
 
-#undef GET_BEFORE_SET
-
-//#define ASYNC // Use SetAsync to set parameters in ADO.
-
-#ifndef ASYNC
 //'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
-// adoSetString: set ado parameter
-
-// reverse engineered DBR types:
-#define DBR_DOUBLE 20
-#define DBR_STRING 14
-
-#define VERB_INFO 1
-#define VERB_DEBUG 2
-#define VERB_DETAILED 4
-extern "C" int gVerb;
-
-extern "C" int adoSetString(const char* adoName, const char* paramName, const char* paramValue, const int type)
+// adoIfOf: the AdoIf of the ADO, created on the first call and kept
+static AdoIf& adoIfOf(const char* adoName)
 {
-#define TIMESTAMPING
-#ifdef TIMESTAMPING
-#define TMPSTRLEN 100
-	char tmpstr[TMPSTRLEN];
-	//int lpname = strlen(paramName);
-	struct timespec ts_now;
-	clock_gettime(CLOCK_REALTIME,&ts_now);
-	snprintf(tmpstr,TMPSTRLEN,"%s:%s",paramName,"timestampSeconds");
-#endif
-	// create AdoIf for the instance someAdo
-	if(gVerb&VERB_DEBUG) printf("ADO %s.%s\tset to %s, type %i\n",adoName,paramName,paramValue,type);
-	AdoIf a(adoName);
-	if(a.CreateOK()!=0) { // check the creation status
+	static std::map<std::string, AdoIf*> adoIfs;
+	std::map<std::string, AdoIf*>::iterator it = adoIfs.find(adoName);
+	if(it != adoIfs.end()) return *it->second;
+	AdoIf *a = new AdoIf(adoName);
+	if(a->CreateOK()!=0) { // check the creation status
 		printf("AdoIf failed : %s\n",
-				RhicErrorNumToErrorStr(a.CreateOK()) );
+				RhicErrorNumToErrorStr(a->CreateOK()) );
 		exit(1);
 	}
-	int stat;
-#ifdef GET_BEFORE_SET
-	// create a value object and use it in Get to get the
-	// parameter "p"
-	Value v(1.0);
-	stat = a.Get(paramName, &v);
-	if(stat!=0) { // check the status
-		if(stat==ADO_FAILED) {
-			const int * indStat = a.GetStatuses();
-			printf("Get for %s failed: %d=%s\n", a.AdoName(),
-					indStat[0], RhicErrorNumToErrorStr(indStat[0]));
-		}
-		else { // some other error
-			printf("ERR: %s\n", RhicErrorNumToErrorStr(stat));
+	adoIfs[adoName] = a;
+	return *a;
+}
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// itemValue: the Value of the write, constructed for the parameter type
+static Value itemValue(const char* adoName, const adoItem &it)
+{
+	if(it.count > 1)
+	{
+		if(gVerb&VERB_DEBUG) printf("ADO %s.%s\tset to %lu elements\n",adoName,it.param,it.count);
+		if(it.type == adoTypeInt)
+		{
+			std::vector<int> iv(it.vec, it.vec + it.count);
+			return Value(&iv[0], (int)it.count);
 		}
-		exit(2);
+		return Value(it.vec, (int)it.count);
 	}
-	// all went well
-	char *aString = v.StringVal(' ');
-	printf("Got the value '%s' from '%s' successfully\n", aString,
-			a.AdoName());
-	delete aString;
-#endif //GET_BEFORE_SET
-
-	// If ADO parameter is defined as number, then it will not accept the string value.
-	// The different Set() functions are used depending of data type.
-	if(type == DBR_DOUBLE)
+	switch(it.type)
 	{
-		if(gVerb&VERB_DETAILED) printf("DBR_DOUBLE=%g\n",atof(paramValue));
-		stat = a.Set(paramName, Value(atof(paramValue)));
-		//stat = a.Set(paramName, Value(paramValue));
+	case adoTypeInt:
+		if(gVerb&VERB_DEBUG) printf("ADO %s.%s\tset to %i\n",adoName,it.param,(int)it.num);
+		return Value((int)it.num);
+	case adoTypeDouble:
+		if(gVerb&VERB_DEBUG) printf("ADO %s.%s\tset to %g\n",adoName,it.param,it.num);
+		return Value(it.num);
+	default:
+		if(gVerb&VERB_DEBUG) printf("ADO %s.%s\tset to %s\n",adoName,it.param,it.str);
+		return Value(it.str);
 	}
-	else
+}
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// setItems: one multi-parameter Set of the n writes and their timestamps,
+// parameter 2*i is the value of item i, 2*i+1 its timestampSeconds: the
+// stamp of the item, or the bridge clock if it has none.
+// Return the status of the Set, the failed parameters are printed.
+static int setItems(AdoIf &a, const char* adoName, const int n, const adoItem items[], const int **indStat)
+{
+	struct timespec ts_now;
+	std::vector<std::string> names;
+	std::vector<const char*> params;
+	std::vector<Value> values;
+	int ii;
+
+	clock_gettime(CLOCK_REALTIME,&ts_now);
+	names.reserve(2*n);
+	values.reserve(2*n);
+	for(ii=0; ii<n; ii++)
 	{
-		if(gVerb&VERB_DETAILED) printf("DBR_STRING=%s\n",(char*)Value(paramValue));
-		stat = a.Set(paramName, Value(paramValue));
+		names.push_back(items[ii].param);
+		values.push_back(itemValue(adoName, items[ii]));
+		names.push_back(std::string(items[ii].param) + ":timestampSeconds");
+		values.push_back(Value(items[ii].stamp ? (int)items[ii].stamp : (int)(ts_now.tv_sec)));
 	}
+	for(ii=0; ii<2*n; ii++) params.push_back(names[ii].c_str());
+	*indStat = NULL;
+	int stat = a.Set(2*n, &params[0], &values[0]);
+	if(stat==0) return 0;
+	if(stat==ADO_FAILED) {
+		*indStat = a.GetStatuses();
+		for(ii=0; ii<2*n; ii++) if((*indStat)[ii]) printf("Set of %s.%s failed: %d=%s\n",
+				a.AdoName(), params[ii], (*indStat)[ii], RhicErrorNumToErrorStr((*indStat)[ii]));
+	}
+	else printf("ERR: %s for %i parameters of %s\n", RhicErrorNumToErrorStr(stat), n, adoName);
+	return stat;
+}
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// adoSetBatch: set n parameters of the ADO and their timestamps with one
+// multi-parameter Set, one round trip per batch. Return the number of
+// failed parameters: their cached type is reset, they are discovered again.
+// A failed timestamp is printed but does not fail the write. The call is
+// synchronous, one Set per ADO is in flight.
+extern "C" int adoSetBatch(const char* adoName, const int n, const adoItem items[])
+{
+	AdoIf &a = adoIfOf(adoName);
+	const int *indStat;
+	int ii, nFailed = 0;
 
-	if(stat!=0) { // check the status
-		if(stat==ADO_FAILED) {
-			const int * indStat = a.GetStatuses();
-			printf("Set for %s failed: %d=%s\n", a.AdoName(),
-					indStat[0], RhicErrorNumToErrorStr(indStat[0]));
-		}
-		else { // some other error
-			printf("ERR: %s for %s type %i\n", RhicErrorNumToErrorStr(stat), paramName, type);
-		}
-		//&RA/exit(3);
-		return 1;
+	if(setItems(a, adoName, n, items, &indStat) == 0) return 0;
+	for(ii=0; ii<n; ii++)
+	{
+		if(indStat && indStat[2*ii] == 0) continue;
+		if(items[ii].cachedType) *items[ii].cachedType = adoTypeUnknown;
+		nFailed++;
 	}
-#ifdef TIMESTAMPING
-	if(gVerb&VERB_DETAILED) printf("Timestamping: %s %i\n",tmpstr,(int)(ts_now.tv_sec));
-	a.Set(tmpstr, Value((int)(ts_now.tv_sec)));
-#endif
-	return 0;
+	return nFailed;
 }
-//,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,
-#endif //ndef ASYNC
-#ifdef ASYNC
 //'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
-// error callback
-int errcb (AdoIf *a, const char* propertyID, const int adoStatus[], int const paramStatus[],
-           const AsyncSetup *setup, void *arg, const void *reqId)
+// adoMakeValues: construct the Values of the writes and drop them, the
+// conversion cost of adoSetBatch without the ADO round trip (benchmarks)
+extern "C" void adoMakeValues(const int n, const adoItem items[])
 {
-  printf("-------for %s status is-------\n", propertyID);
-  printf("ado error is  %s\n", RhicErrorNumToErrorStr(adoStatus[0]));
-  if(adoStatus[0]==ADO_FAILED)printf("param error is    %s\n", RhicErrorNumToErrorStr(paramStatus[0]));
-  return TRUE;
+	for(int ii=0; ii<n; ii++)
+	{
+		Value v = itemValue("", items[ii]);
+	}
 }
-extern "C" int adoSetString(char* adoName, char* paramName, char* paramValue)
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// adoSetGroup: set n parameters of the ADO and their timestamps with one
+// multi-parameter Set, so that ADO clients see them change together. The
+// batch is one such Set too, so the statuses are handled as adoSetBatch does.
+extern "C" int adoSetGroup(const char* adoName, const int n, const adoItem items[])
 {
-//int main(int argc, char *argv[])
+	return adoSetBatch(adoName, n, items);
+}
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// adoDiscover: type and number of elements of the ADO parameter, from its
+// current value
+extern "C" int adoDiscover(const char* adoName, const char* paramName, unsigned long *length)
 {
-  // create the async handler
-  AsyncHandler *ah = new AsyncHandler();
-
-  // create AsyncSetup object for SetAsync
-  AsyncSetup *ssetup = new SetAsyncSetup (errcb);
-
-  // always receive status
-  ssetup->SetReceiveStatus();
-
-  // create adoif
-  AdoIf *a = new AdoIf(adoName);
-  if(a->CreateOK()!=0){
-    printf("%s\n", RhicErrorNumToErrorStr(errno));
-    exit(0);
-  }
-
-  // create Value object to send data
-  Value **data = (Value **)malloc(sizeof(Value *)*2);
-  data[1] = NULL;
-
-  // call SetAsync
-  Value *val = new Value(33);
-  data[0] = val;
-  cout<<">SetAsync "<<val<<endl;
-  int stat = a->SetAsync(paramName, ssetup, paramValue);
-  delete val;
-
-  // handle events
-  ah->HandleEvents();
-  return 0;
+	AdoIf &a = adoIfOf(adoName);
+	Value v;
+	int stat = a.Get(paramName, &v);
+	if(stat!=0) { // check the status
+		printf("Get for %s.%s failed: %s\n", adoName, paramName, RhicErrorNumToErrorStr(stat));
+		return adoTypeGuess;
+	}
+	*length = v.Length();
+	switch(v.Type())
+	{
+	case CHAR_TYPE: case UCHAR_TYPE: case SHORT_TYPE: case USHORT_TYPE:
+	case INT_TYPE: case UINT_TYPE: case LONG_TYPE: case ULONG_TYPE:
+		return adoTypeInt;
+	case FLOAT_TYPE: case DOUBLE_TYPE:
+		return adoTypeDouble;
+	case STRING_TYPE:
+		return adoTypeString;
+	default:
+		return adoTypeGuess;
+	}
 }
 //,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,
-#endif //ASYNC
@@ -0,0 +1,130 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Declarations shared by the EPICS and ADO sides of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Map records with options, verbosity mask.
+ * version v02 2026-10-19. Batch setter.
+ * version v03 2026-10-19. ADO parameter types discovered and cached in the map record.
+ * version v04 2026-10-19. Value transform, array items.
+ * version v05 2026-10-19. Waveform reduction with extra output parameters.
+ * version v06 2026-10-19. Write groups, group setter.
+ * version v07 2026-10-19. Map functions, adoMakeValues for the benchmarks.
+ * version v08 2026-10-19. ADO of the map record, rows of one PV chained.
+ * version v09 2026-10-19. Ingestion source of the map record.
+ * version v10 2026-10-19. Delta mode of the map record.
+ * version v11 2026-10-19. Map record and warm cache hash of the write.
+ * version v12 2026-10-19. adoSetString removed, the writes go through adoSetBatch and adoSetGroup.
+ * version v13 2026-10-19. Timestamp of the write.
+ */
+
+#ifndef INCLepics2adoh
+#define INCLepics2adoh
+
+#include <stdint.h>
+
+#define VERB_INFO 1
+#define VERB_DEBUG 2
+#define VERB_DETAILED 4
+
+#define MAP_MAX_OUTS 4      /* Max number of out= parameters of a map record */
+
+/* Ingestion of the channel (src= map option) */
+typedef enum {srcCA, srcPVA} SourceT;
+
+struct xfProg;              /* Compiled value transform, see xf.h */
+
+/* Type of an ADO parameter, selects the Value constructor of the Set */
+typedef enum
+{
+    adoTypeUnknown,     // not discovered yet: discover on the next write
+    adoTypeGuess,       // discovery failed: double for DBR_TIME_DOUBLE, otherwise string
+    adoTypeString,
+    adoTypeInt,
+    adoTypeDouble
+} AdoTypeT;
+
+/* One record of the epics-to-ado map (one line of the csv file).
+ * The first three columns are positional, the optional columns after them
+ * have the form key=value, see parse_map_option() */
+typedef struct mapRec
+{
+    char *pvName;   // column 0: epics PV name
+    char  dir;      // column 1: data direction: '>', '<' or 'x'
+    char *param;    // column 2: ado parameter name
+    char *ado;      // ado=<name>: ADO of the parameter, NULL: (default) the ADO of the command line
+    int   prio;     // prio=<n>: priority class, 0 (default, lowest) .. SCHED_NCLASS-1
+    int   ovf;      // ovf=<policy>: overflow policy (OverflowT), default ovfLatest
+    int   depth;    // depth=<n>: max queued updates, 0: default SCHED_DEPTH
+    unsigned long mask; // mask=<valp>: CA event mask, 0: -m option
+    unsigned long nelm; // nelm=<n>: max number of requested elements, 0: -# option
+    int   dyn;      // dyn=0|1: dynamic array length, 1: (default) current length, 0: full length
+    double rate;    // rate=<hz>: max rate of the ADO writes, 0: (default) no limit
+    int   src;      // src=ca|pva: ingestion (SourceT), srcCA: (default) Channel Access
+    char *field;    // field=<path>: pvAccess field of the value, NULL: (default) 'value'
+    struct xfProg *xf; // xf=<expr>: value transform, NULL: (default) none
+    int   red;      // red=<kind>[:<n>]: waveform reduction (ReduceT), redNone: (default) none
+    unsigned long redN; // block size or stride of the reduction
+    char *outs[MAP_MAX_OUTS]; // out=<p1>;<p2>..: further ado parameters of the reduced value
+    int   nOuts;    // number of out= parameters
+    int   grp;      // grp=<name>: write group number + 1, 0: (default) not grouped
+    int   grpMember; // member index of the channel in the group
+    int   delta;    // delta=0|1: 1: values equal to the last written one are not written, 0: (default) all
+    int   nextRow;  // next map record of the same PV, -1: none
+    int   adoType;  // AdoTypeT of the ADO parameter, discovered at startup
+    unsigned long adoLength; // number of elements of the ADO parameter
+} mapRec;
+
+/* One parameter write of a batch */
+typedef struct adoItem
+{
+    const char *param;  // ADO parameter name
+    int   type;         // AdoTypeT, resolved: adoTypeString, adoTypeInt or adoTypeDouble
+    double num;         // value of adoTypeInt and adoTypeDouble parameters
+    const char *str;    // value of adoTypeString parameters
+    unsigned long count; // number of elements, > 1: array value in vec
+    const double *vec;  // elements of array parameters
+    int  *cachedType;   // type cache of the binding, reset to adoTypeUnknown if the Set fails
+    int   row;          // map record of the write, -1: none
+    uint64_t hash;      // warm cache: value hash on the last write of the update, 0: other writes
+    uint32_t stamp;     // timestampSeconds written with the value (POSIX), 0: the bridge clock
+} adoItem;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int gVerb;           /* Verbosity mask (-v option) */
+
+/* adoSetBatch defined in epics2ado.cxx: set n parameters of the ADO,
+ * returns the number of failed parameters */
+extern int adoSetBatch(const char* adoName, const int n, const adoItem items[]);
+
+/* adoSetGroup defined in epics2ado.cxx: set n parameters of the ADO with
+ * one multi-parameter Set; returns the number of failed parameters */
+extern int adoSetGroup(const char* adoName, const int n, const adoItem items[]);
+
+/* adoDiscover defined in epics2ado.cxx: AdoTypeT and number of elements
+ * of the ADO parameter, adoTypeGuess if it could not be read */
+extern int adoDiscover(const char* adoName, const char* paramName, unsigned long *length);
+
+/* adoMakeValues defined in epics2ado.cxx: construct the Values of the
+ * writes as adoSetBatch does, without sending them (benchmarks) */
+extern void adoMakeValues(const int n, const adoItem items[]);
+
+/* The map, defined in camonitor.c */
+extern int parse_epics2ado_csvmap(const char *filename, const int selectkey, mapRec recs[],
+                                  const int max_recs, char *storage, const int storage_size);
+extern char* pv2param(const char* pvname, const mapRec table[], const int nrows);
+
+/* The ADO setter and discovery used by the bridge, from epics2ado.cxx or
+ * the mock sink of the soak test */
+typedef int adoSetBatchFunc(const char* adoName, const int n, const adoItem items[]);
+typedef int adoDiscoverFunc(const char* adoName, const char* paramName, unsigned long *length);
+extern adoSetBatchFunc *gAdoSetBatch;
+extern adoSetBatchFunc *gAdoSetGroup;
+extern adoDiscoverFunc *gAdoDiscover;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef INCLepics2adoh */
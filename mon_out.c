@@ -0,0 +1,303 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Monitor output of the epics to ado bridge (-o option)
+ *
+ * version v01 2026-10-19. Buffered text, JSON lines and binary records.
+ * version v02 2026-10-19. stdout buffer of the text format set before the first output.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/uio.h>
+
+#include <epicsTime.h>
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "mon_out.h"
+
+OutFormatT gOutFormat = outNone;
+
+static const char *gOutFormatNames[] = {"none", "text", "json", "bin", NULL};
+
+static char *gBuf = NULL;           // output buffer
+static size_t gLen = 0;             // bytes in the buffer
+static pv *gOutPvs = NULL;
+static char *gNameSent = NULL;      // bin: name record of the PV written
+
+static unsigned long gPrefixSec = 0; // second of the cached timestamp prefix
+static char gPrefix[32];            // "YYYY-mm-ddTHH:MM:SS"
+static size_t gPrefixLen = 0;
+
+// mon_out_format
+// return the OutFormatT for the format name, -1 if not known
+int mon_out_format (const char *name)
+{
+    int ii;
+    for (ii=0; gOutFormatNames[ii]; ii++)
+        if (strcmp(gOutFormatNames[ii], name) == 0) return ii;
+    return -1;
+}
+
+static void write_all (const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(STDOUT_FILENO, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;                     /* nothing sensible to do, drop the output */
+        }
+        buf += n;
+        len -= n;
+    }
+}
+
+/* writev(2) of all the vectors, continuing after partial writes */
+static void writev_all (struct iovec *iov, int cnt)
+{
+    while (cnt > 0) {
+        ssize_t n = writev(STDOUT_FILENO, iov, cnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        while (cnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            cnt--;
+        }
+        if (cnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+void mon_out_flush (void)
+{
+    if (gOutFormat == outText) {
+        fflush(stdout);
+        return;
+    }
+    if (gLen == 0) return;
+    fflush(stdout);                     /* keep the order with the printf output */
+    write_all(gBuf, gLen);
+    gLen = 0;
+}
+
+/* Make room for n bytes in the buffer */
+static char *reserve (size_t n)
+{
+    if (gLen + n > MON_OUT_BUFSIZE) mon_out_flush();
+    return gBuf + gLen;
+}
+
+static void put_mem (const char *s, size_t n)
+{
+    if (n > MON_OUT_BUFSIZE) {
+        mon_out_flush();
+        write_all(s, n);
+        return;
+    }
+    memcpy(reserve(n), s, n);
+    gLen += n;
+}
+
+static void put_char (char c)
+{
+    *reserve(1) = c;
+    gLen++;
+}
+
+static void put_long (long v)
+{
+    char tmp[24];
+    char *p = tmp + sizeof(tmp);
+    unsigned long u = v < 0 ? -(unsigned long)v : (unsigned long)v;
+    do {
+        *--p = '0' + u % 10;
+        u /= 10;
+    } while (u);
+    if (v < 0) *--p = '-';
+    put_mem(p, tmp + sizeof(tmp) - p);
+}
+
+static void put_double (double v)
+{
+    if (v != v || v - v != 0.) {        /* NaN and Inf are not JSON */
+        put_mem("null", 4);
+        return;
+    }
+    gLen += snprintf(reserve(32), 32, "%.15g", v);
+}
+
+static void put_json_string (const char *s, size_t maxLen)
+{
+    size_t ii;
+    put_char('"');
+    for (ii = 0; ii < maxLen && s[ii]; ii++) {
+        unsigned char c = s[ii];
+        if (c == '"' || c == '\\') {
+            put_char('\\');
+            put_char(c);
+        } else if (c < 0x20) {
+            gLen += snprintf(reserve(8), 8, "\\u%04x", c);
+        } else put_char(c);
+    }
+    put_char('"');
+}
+
+/* ISO timestamp, the part up to the seconds is formatted once per second */
+static void put_timestamp (const epicsTimeStamp *ts)
+{
+    char *p;
+    unsigned long ns = ts->nsec;
+    int ii;
+
+    if (ts->secPastEpoch != gPrefixSec || gPrefixLen == 0) {
+        gPrefixLen = epicsTimeToStrftime(gPrefix, sizeof(gPrefix), "%Y-%m-%dT%H:%M:%S", ts);
+        gPrefixSec = ts->secPastEpoch;
+    }
+    put_mem(gPrefix, gPrefixLen);
+    p = reserve(10);
+    p[0] = '.';
+    for (ii = 9; ii > 0; ii--) {
+        p[ii] = '0' + ns % 10;
+        ns /= 10;
+    }
+    gLen += 10;
+}
+
+/* mon_out_stdout - text: stdout fully buffered, called before anything is
+ * written to stdout, as setvbuf() must be */
+void mon_out_stdout (void)
+{
+    if (gOutFormat == outText) setvbuf(stdout, NULL, _IOFBF, MON_OUT_BUFSIZE);
+}
+
+int mon_out_init (pv *pvs, int nPvs)
+{
+    gOutPvs = pvs;
+    if (gOutFormat == outText) return 0;
+    gBuf = malloc(MON_OUT_BUFSIZE);
+    gNameSent = calloc(nPvs, 1);
+    return !gBuf || !gNameSent;
+}
+
+static void json_value (const void *val_ptr, unsigned base_type, unsigned long index)
+{
+    switch (base_type) {
+    case DBR_STRING:
+        put_json_string(((dbr_string_t*) val_ptr)[index], MAX_STRING_SIZE);
+        break;
+    case DBR_FLOAT:  put_double(((dbr_float_t*) val_ptr)[index]); break;
+    case DBR_DOUBLE: put_double(((dbr_double_t*) val_ptr)[index]); break;
+    case DBR_CHAR:   put_long(((dbr_char_t*) val_ptr)[index]); break;
+    case DBR_INT:    put_long(((dbr_int_t*) val_ptr)[index]); break;
+    case DBR_LONG:   put_long(((dbr_long_t*) val_ptr)[index]); break;
+    case DBR_ENUM:   put_long(((dbr_enum_t*) val_ptr)[index]); break;
+    }
+}
+
+static void json_event (pv *ppv)
+{
+    const struct dbr_time_double *hdr = ppv->value;    /* same header for all DBR_TIME */
+    const void *val_ptr = dbr_value_ptr(ppv->value, ppv->dbrType);
+    unsigned base_type = ppv->dbrType % (LAST_TYPE+1);
+    unsigned long ii;
+
+    put_mem("{\"pv\":", 6);
+    put_json_string(ppv->name, (size_t)-1);
+    put_mem(",\"ts\":\"", 7);
+    put_timestamp(&hdr->stamp);
+    put_mem("\",\"stat\":", 9);
+    put_long(hdr->status);
+    put_mem(",\"sevr\":", 8);
+    put_long(hdr->severity);
+    put_mem(",\"n\":", 5);
+    put_long(ppv->nElems);
+    put_mem(",\"v\":", 5);
+    if (charArrAsStr && base_type == DBR_CHAR && ppv->nElems > 1)
+        put_json_string(val_ptr, ppv->nElems);
+    else if (ppv->nElems == 1)
+        json_value(val_ptr, base_type, 0);
+    else {
+        put_char('[');
+        for (ii = 0; ii < ppv->nElems; ii++) {
+            if (ii) put_char(',');
+            json_value(val_ptr, base_type, ii);
+        }
+        put_char(']');
+    }
+    put_mem("}\n", 2);
+}
+
+static void bin_record (pv *ppv, unsigned dbrType, const void *payload, size_t size, unsigned long count)
+{
+    const struct dbr_time_double *hdr = ppv->value;
+    size_t padded = (size + 7) & ~(size_t)7;
+    monRecord rec;
+    static const char zeros[8] = {0};
+
+    memset(&rec, 0, sizeof(rec));
+    rec.magic = MON_RECORD_MAGIC;
+    rec.length = sizeof(rec) + padded;
+    rec.pvIndex = ppv - gOutPvs;
+    rec.count = count;
+    rec.dbrType = dbrType;
+    if (hdr && dbrType != MON_RECORD_NAME) {
+        rec.secPastEpoch = hdr->stamp.secPastEpoch;
+        rec.nsec = hdr->stamp.nsec;
+        rec.status = hdr->status;
+        rec.severity = hdr->severity;
+    }
+    if (sizeof(rec) + padded > MON_OUT_BUFSIZE) {
+        struct iovec iov[4];    /* large array: one writev of buffer, header and values */
+        iov[0].iov_base = gBuf;           iov[0].iov_len = gLen;
+        iov[1].iov_base = &rec;           iov[1].iov_len = sizeof(rec);
+        iov[2].iov_base = (void *)payload; iov[2].iov_len = size;
+        iov[3].iov_base = (void *)zeros;  iov[3].iov_len = padded - size;
+        fflush(stdout);
+        writev_all(iov, 4);
+        gLen = 0;
+        return;
+    }
+    put_mem((const char *)&rec, sizeof(rec));
+    put_mem(payload, size);
+    put_mem(zeros, padded - size);
+}
+
+static void bin_event (pv *ppv)
+{
+    int idx = ppv - gOutPvs;
+
+    if (!gNameSent[idx]) {
+        bin_record(ppv, MON_RECORD_NAME, ppv->name, strlen(ppv->name) + 1, 1);
+        gNameSent[idx] = 1;
+    }
+    bin_record(ppv, ppv->dbrType, dbr_value_ptr(ppv->value, ppv->dbrType),
+               ppv->nElems*dbr_value_size[ppv->dbrType], ppv->nElems);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	mon_out_event
+ *
+ * Description:	Output the monitor event in the selected format
+ *
+ * Arg(s) In:	ppv       -  Pointer to pv structure, with the DBR_TIME data
+ *                           in value, dbrType and nElems
+ *              reqElems  -  Number of requested elements (text format)
+ *
+ **************************************************************************-*/
+
+void mon_out_event (pv *ppv, unsigned long reqElems)
+{
+    switch (gOutFormat) {
+    case outText: print_time_val_sts(ppv, reqElems); break;
+    case outJson: json_event(ppv); break;
+    case outBin:  bin_event(ppv); break;
+    default: break;
+    }
+}
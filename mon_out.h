@@ -0,0 +1,49 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Monitor output of the epics to ado bridge (-o option)
+ *
+ * The events are formatted into one large buffer which is written to stdout
+ * with write(2) when it fills up and after each batch of events.
+ *   text - camonitor style lines (print_time_val_sts), stdout fully buffered
+ *   json - one compact JSON object per line:
+ *          {"pv":"<name>","ts":"<ISO time>","stat":<n>,"sevr":<n>,"n":<count>,"v":<value or [values]>}
+ *   bin  - fixed size monRecord header followed by the raw DBR values,
+ *          padded to 8 bytes. The first record of each PV has
+ *          dbrType = MON_RECORD_NAME and carries the PV name.
+ */
+
+#ifndef INCLmon_outh
+#define INCLmon_outh
+
+#include <stdint.h>
+
+#define MON_OUT_BUFSIZE (256*1024)  /* Size of the output buffer */
+#define MON_RECORD_MAGIC 0x52413245  /* "E2AR" little endian */
+#define MON_RECORD_NAME 0xFFFF       /* dbrType of the PV name record */
+
+/* Output formats for the monitor events */
+typedef enum { outNone, outText, outJson, outBin } OutFormatT;
+
+/* Header of the binary record, all fields in host byte order */
+typedef struct monRecord
+{
+    uint32_t magic;         // MON_RECORD_MAGIC
+    uint32_t length;        // record length including the header, multiple of 8
+    uint32_t pvIndex;       // index of the PV in the map
+    uint32_t count;         // number of elements
+    uint32_t secPastEpoch;  // server timestamp, EPICS epoch
+    uint32_t nsec;
+    uint16_t dbrType;       // DBR_TIME_xxx of the values, MON_RECORD_NAME
+    uint16_t status;
+    uint16_t severity;
+    uint16_t pad;
+} monRecord;
+
+extern OutFormatT gOutFormat;   /* Monitor output format (-o option) */
+
+extern int  mon_out_format (const char *name);
+extern void mon_out_stdout (void);
+extern int  mon_out_init (pv *pvs, int nPvs);
+extern void mon_out_event (pv *ppv, unsigned long reqElems);
+extern void mon_out_flush (void);
+
+#endif /* ifndef INCLmon_outh */
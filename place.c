@@ -0,0 +1,314 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Thread placement of the epics to ado bridge
+ *
+ * version v01 2026-10-19. CPU affinity, SCHED_FIFO, NUMA memory policy.
+ * version v02 2026-10-19. CA threads placed by thread id once they exist.
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+
+#include "place.h"
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1            /* from linux/mempolicy.h */
+#endif
+#define PLACE_MAX_NODES 64
+
+/* Placement of a group of threads */
+typedef struct threadPlace
+{
+    int       set;                  // 0: not configured, inherit
+    cpu_set_t cpus;
+    int       prio;                 // SCHED_FIFO priority, 0: SCHED_OTHER
+} threadPlace;
+
+static const char *gPlaceNames[] = {"event loop", "CA threads"};
+static threadPlace gPlaces[2];
+static int gPlaceNode = PLACE_NODE_NONE;
+static int gNodeApplied = PLACE_NODE_NONE;  /* node of the memory policy */
+static pid_t gLoopTid = 0;          /* thread id of the event loop */
+static pid_t *gPlacedTids = NULL;   /* threads given the CA placement */
+static int gNPlaced = 0, gPlacedSize = 0;
+
+/*+**************************************************************************
+ *
+ * Function:	place_parse
+ *
+ * Description:	Interpret the -A or -a option
+ *
+ * Arg(s) In:	which  -  PLACE_LOOP or PLACE_CA
+ *              spec   -  <cpus>[:<prio>], cpus: list of numbers and ranges
+ *
+ * Return(s):	0 - success, 1 - invalid spec
+ *
+ **************************************************************************-*/
+
+int place_parse (int which, const char *spec)
+{
+    threadPlace *place = &gPlaces[which];
+    const char *p = spec;
+    char *end;
+    long lo, hi, cpu;
+
+    CPU_ZERO(&place->cpus);
+    place->prio = 0;
+    do {
+        lo = hi = strtol(p, &end, 10);
+        if (end == p || lo < 0) return 1;
+        if (*end == '-') {
+            p = end + 1;
+            hi = strtol(p, &end, 10);
+            if (end == p || hi < lo) return 1;
+        }
+        if (hi >= CPU_SETSIZE) return 1;
+        for (cpu = lo; cpu <= hi; cpu++) CPU_SET(cpu, &place->cpus);
+        p = end + 1;
+    } while (*end == ',');
+    if (*end == ':') {
+        place->prio = strtol(p, &end, 10);
+        if (end == p || place->prio < sched_get_priority_min(SCHED_FIFO)
+            || place->prio > sched_get_priority_max(SCHED_FIFO)) return 1;
+    }
+    if (*end != '\0') return 1;
+    place->set = 1;
+    return 0;
+}
+
+// place_parse_node - interpret the -N option: 'local' or a node number, return 0 or 1 if invalid
+int place_parse_node (const char *spec)
+{
+    char *end;
+    long node;
+
+    if (strcmp(spec, "local") == 0) {
+        gPlaceNode = PLACE_NODE_LOCAL;
+        return 0;
+    }
+    node = strtol(spec, &end, 10);
+    if (end == spec || *end != '\0' || node < 0 || node >= PLACE_MAX_NODES) return 1;
+    gPlaceNode = node;
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	place_apply
+ *
+ * Description:	Apply the placement to the calling thread
+ *
+ * Arg(s) In:	which  -  PLACE_LOOP or PLACE_CA, nothing is done if not
+ *                        configured; PLACE_CA falls back to PLACE_LOOP
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int place_apply (int which)
+{
+    const threadPlace *place = &gPlaces[which];
+    const char *what = gPlaceNames[which];
+    struct sched_param sp;
+    int err;
+
+    if (which == PLACE_LOOP) gLoopTid = syscall(SYS_gettid);
+    if (which == PLACE_CA && !place->set) place = &gPlaces[PLACE_LOOP];
+    if (!place->set) return 0;
+    err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &place->cpus);
+    if (err) {
+        fprintf(stderr, "CPU affinity of the %s: %s\n", what, strerror(err));
+        return 1;
+    }
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = place->prio;
+    err = pthread_setschedparam(pthread_self(), place->prio ? SCHED_FIFO : SCHED_OTHER, &sp);
+    if (err) {
+        fprintf(stderr, "SCHED_FIFO priority %i of the %s: %s\n", place->prio, what, strerror(err));
+        return 1;
+    }
+    return 0;
+}
+
+/* Thread placed already */
+static int placed (pid_t tid)
+{
+    int ii;
+    for (ii = 0; ii < gNPlaced; ii++)
+        if (gPlacedTids[ii] == tid) return 1;
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	place_threads
+ *
+ * Description:	Give the CA placement to the threads of the process which
+ *              did not get it yet, all but the event loop thread. libca
+ *              creates its UDP and TCP threads when the channels are
+ *              created and connect, so this is called after the channels
+ *              connected and periodically for the circuits which come later.
+ *
+ * Return(s):	number of threads placed, -1 - error
+ *
+ **************************************************************************-*/
+
+int place_threads (void)
+{
+    const threadPlace *place = gPlaces[PLACE_CA].set ? &gPlaces[PLACE_CA] : &gPlaces[PLACE_LOOP];
+    struct sched_param sp;
+    struct dirent *de;
+    DIR *d;
+    int n = 0;
+
+    if (!place->set) return 0;
+    d = opendir("/proc/self/task");
+    if (!d) {
+        perror("/proc/self/task");
+        return -1;
+    }
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = place->prio;
+    while ((de = readdir(d)) != NULL)
+    {
+        pid_t tid = atoi(de->d_name);
+        if (tid <= 0 || tid == gLoopTid || placed(tid)) continue;
+        if (gNPlaced == gPlacedSize) {
+            pid_t *p = realloc(gPlacedTids, (gPlacedSize + 16)*sizeof(pid_t));
+            if (!p) break;
+            gPlacedTids = p;
+            gPlacedSize += 16;
+        }
+        gPlacedTids[gNPlaced++] = tid;      /* tried once, also if it failed */
+        if (sched_setaffinity(tid, sizeof(cpu_set_t), &place->cpus)) {
+            if (errno == ESRCH) continue;   /* exited meanwhile */
+            fprintf(stderr, "CPU affinity of CA thread %i: %s\n", (int)tid, strerror(errno));
+            n = -1;
+            break;
+        }
+        if (sched_setscheduler(tid, place->prio ? SCHED_FIFO : SCHED_OTHER, &sp)) {
+            fprintf(stderr, "SCHED_FIFO priority %i of CA thread %i: %s\n", place->prio, (int)tid, strerror(errno));
+            n = -1;
+            break;
+        }
+        n++;
+    }
+    closedir(d);
+    return n;
+}
+
+/* NUMA node of the CPU, from sysfs, -1 if not known */
+static int cpu_node (int cpu)
+{
+    char path[64];
+    DIR *d;
+    struct dirent *de;
+    int node = -1;
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%i", cpu);
+    d = opendir(path);
+    if (!d) return -1;
+    while ((de = readdir(d)) != NULL)
+        if (strncmp(de->d_name, "node", 4) == 0) {
+            node = atoi(de->d_name + 4);
+            break;
+        }
+    closedir(d);
+    return node;
+}
+
+/* First CPU of the set, -1 if empty */
+static int first_cpu (const cpu_set_t *cpus)
+{
+    int cpu;
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        if (CPU_ISSET(cpu, cpus)) return cpu;
+    return -1;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	place_memory
+ *
+ * Description:	Prefer the -N node for the memory allocated from now on by
+ *              the calling thread and the threads it creates
+ *
+ * Return(s):	0 - success or -N not given, 1 - error
+ *
+ **************************************************************************-*/
+
+int place_memory (void)
+{
+    unsigned long mask;
+    int node = gPlaceNode;
+
+    if (node == PLACE_NODE_NONE) return 0;
+    if (node == PLACE_NODE_LOCAL)
+    {
+        cpu_set_t cpus;
+        if (gPlaces[PLACE_LOOP].set) cpus = gPlaces[PLACE_LOOP].cpus;
+        else if (sched_getaffinity(0, sizeof(cpus), &cpus)) return 1;
+        node = cpu_node(first_cpu(&cpus));
+        if (node < 0) {
+            fprintf(stderr, "NUMA node of the event loop CPUs not known\n");
+            return 1;
+        }
+    }
+    mask = 1UL << node;
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask)*8)) {
+        fprintf(stderr, "Memory policy for NUMA node %i: %s\n", node, strerror(errno));
+        return 1;
+    }
+    gNodeApplied = node;
+    return 0;
+}
+
+/* Print the CPU list, ranges compressed */
+static void print_cpus (FILE *stream, const cpu_set_t *cpus)
+{
+    int cpu, last, first = 1;
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++)
+    {
+        if (!CPU_ISSET(cpu, cpus)) continue;
+        for (last = cpu; last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, cpus); last++) ;
+        fprintf(stream, first ? "%i" : ",%i", cpu);
+        if (last > cpu) fprintf(stream, "-%i", last);
+        first = 0;
+        cpu = last;
+    }
+}
+
+static void report_cpus (FILE *stream, const cpu_set_t *cpus)
+{
+    print_cpus(stream, cpus);
+    fprintf(stream, " (node %i)", cpu_node(first_cpu(cpus)));
+}
+
+// place_report - print the thread layout, called from the event loop thread
+void place_report (FILE *stream)
+{
+    struct sched_param sp;
+    cpu_set_t cpus;
+    int policy;
+
+    fprintf(stream, "Thread placement:\n  event loop: CPUs ");
+    if (sched_getaffinity(0, sizeof(cpus), &cpus) == 0) report_cpus(stream, &cpus);
+    if (pthread_getschedparam(pthread_self(), &policy, &sp) == 0)
+        fprintf(stream, policy == SCHED_FIFO ? ", SCHED_FIFO %i\n" : ", SCHED_OTHER\n", sp.sched_priority);
+    fprintf(stream, "  CA threads: ");
+    if (gPlaces[PLACE_CA].set) {
+        fprintf(stream, "CPUs ");
+        report_cpus(stream, &gPlaces[PLACE_CA].cpus);
+        fprintf(stream, gPlaces[PLACE_CA].prio ? ", SCHED_FIFO %i\n" : ", SCHED_OTHER\n", gPlaces[PLACE_CA].prio);
+    }
+    else fprintf(stream, gPlaces[PLACE_LOOP].set ? "as the event loop\n" : "inherited\n");
+    if (gNPlaced) fprintf(stream, "  CA threads placed: %i\n", gNPlaced);
+    if (gNodeApplied >= 0) fprintf(stream, "  memory: NUMA node %i preferred\n", gNodeApplied);
+    else                   fprintf(stream, "  memory: default policy\n");
+}
@@ -0,0 +1,38 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Thread placement of the epics to ado bridge (-A, -a and -N options)
+ *
+ * The bridge runs the event loop, which does the CA callbacks, the queueing
+ * and the ADO writes, in the main thread; libca runs its own receive and
+ * send threads. Both can be pinned to CPUs and given a SCHED_FIFO priority:
+ *   -A <cpus>[:<prio>]  event loop (main) thread
+ *   -a <cpus>[:<prio>]  CA threads, default as -A: libca creates its UDP and
+ *                       TCP threads when the channels are created and connect,
+ *                       from the event loop thread, so they would inherit -A.
+ *                       All threads but the event loop are given this
+ *                       placement by thread id after the channels connected
+ *                       and every PLACE_PERIOD seconds for new circuits. A
+ *                       thread which starts between two passes runs with -A
+ *                       until the next one.
+ * <cpus> is a list like 2,3 or 4-7. The memory of the queues and buffers,
+ * allocated on first use, is placed with -N on a NUMA node: 'local' - the
+ * node of the event loop CPUs, or a node number. The layout is reported at
+ * startup.
+ */
+
+#ifndef INCLplaceh
+#define INCLplaceh
+
+#define PLACE_LOOP 0                /* -A: event loop (main) thread */
+#define PLACE_CA 1                  /* -a: CA threads */
+#define PLACE_NODE_NONE -1          /* -N not given: default memory policy */
+#define PLACE_NODE_LOCAL -2         /* -N local */
+#define PLACE_PERIOD 5.             /* Period of the CA thread placement, s */
+
+extern int  place_parse (int which, const char *spec);
+extern int  place_parse_node (const char *spec);
+extern int  place_apply (int which);
+extern int  place_threads (void);
+extern int  place_memory (void);
+extern void place_report (FILE *stream);
+
+#endif /* ifndef INCLplaceh */
@@ -0,0 +1,43 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Static tracepoints (USDT) of the epics to ado bridge
+ *
+ * With <sys/sdt.h> (systemtap-sdt-dev) each probe is compiled to a nop and
+ * an ELF note; perf, bpftrace or systemtap attach to it by name, it costs
+ * nothing while nothing is attached. Provider epics2ado, the id is the
+ * channel index (the map order, see -v1 at startup):
+ *   event     id, secPastEpoch, nsec, count  monitor update received
+ *                                            (CA event_handler, pvAccess)
+ *   coalesce  id, depth                      queued update overwritten
+ *   drop      id, policy                     update lost on overflow
+ *   dequeue   id, wait ns                    update handed to the writer
+ *   convert   id, row, adoType, count        value converted for a map record
+ *   set_begin ado, n, grouped                ADO Set of n parameters
+ *   set_end   ado, n, failed
+ *   connect   id, up                         channel connected, disconnected
+ * Example, the distribution of the queueing delay:
+ *   bpftrace -e 'usdt:./epics2ado:epics2ado:dequeue { @us = hist(arg1/1000); }'
+ * Without <sys/sdt.h>, or with EPICS2ADO_NO_SDT defined, the probes are
+ * compiled out.
+ */
+
+#ifndef INCLprobesh
+#define INCLprobesh
+
+#if !defined(EPICS2ADO_NO_SDT) && defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#    include <sys/sdt.h>
+#    define E2A_SDT 1
+#  endif
+#endif
+
+#ifdef E2A_SDT
+#  define E2A_PROBE2(name, a, b)        DTRACE_PROBE2(epics2ado, name, a, b)
+#  define E2A_PROBE3(name, a, b, c)     DTRACE_PROBE3(epics2ado, name, a, b, c)
+#  define E2A_PROBE4(name, a, b, c, d)  DTRACE_PROBE4(epics2ado, name, a, b, c, d)
+#else
+#  define E2A_PROBE2(name, a, b)        do {} while (0)
+#  define E2A_PROBE3(name, a, b, c)     do {} while (0)
+#  define E2A_PROBE4(name, a, b, c, d)  do {} while (0)
+#endif
+
+#endif /* ifndef INCLprobesh */
@@ -0,0 +1,214 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Channel metadata cache of the epics to ado bridge
+ *
+ * version v01 2026-10-19. DBR_CTRL on connect and on DBE_PROPERTY.
+ * version v02 2026-10-19. Enum updates held until the enum strings arrive.
+ * version v03 2026-10-19. Units always terminated.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "pv_meta.h"
+
+#define COPY_UNITS(T) \
+    snprintf(m->units, sizeof(m->units), "%.*s", MAX_UNITS_SIZE, ((struct T *)args.dbr)->units)
+
+/* Enum update waiting for the metadata of its channel */
+typedef struct metaHeld
+{
+    pv    *ppv;
+    long  type;
+    unsigned long count;
+    void  *dbr;
+    size_t size;                    // allocated for dbr
+    metaEventFunc *fn;              // called with the update when released
+    struct metaHeld *next;
+} metaHeld;
+
+static metaHeld *gHeld = NULL;      // few, only until the metadata arrives
+
+/* Hand on the held update of the channel */
+static void meta_release (pv *ppv)
+{
+    metaHeld **pp, *h;
+
+    for (pp = &gHeld; *pp && (*pp)->ppv != ppv; pp = &(*pp)->next) ;
+    if (!(h = *pp)) return;
+    *pp = h->next;
+    if (h->dbr) h->fn(ppv, h->type, h->count, h->dbr);
+    free(h->dbr);
+    free(h);
+}
+
+/* No metadata will come: an empty one, the enums go on as their index */
+static void meta_none (pv *ppv)
+{
+    if (!ppv->meta) ppv->meta = calloc(1, sizeof(struct pvMeta));
+    if (ppv->meta) meta_release(ppv);
+}
+
+/* meta_handler - CA callback of the DBR_CTRL subscription */
+static void meta_handler (evargs args)
+{
+    pv *ppv = args.usr;
+    struct pvMeta *m = ppv->meta;
+
+    if (args.status != ECA_NORMAL) {
+        meta_none(ppv);
+        return;
+    }
+    if (!m) {
+        m = calloc(1, sizeof(struct pvMeta));
+        if (!m) return;
+    }
+    switch (args.type) {
+    case DBR_CTRL_ENUM:
+        {
+            const struct dbr_ctrl_enum *e = args.dbr;
+            m->noStr = e->no_str > MAX_ENUM_STATES ? MAX_ENUM_STATES : e->no_str;
+            memcpy(m->strs, e->strs, sizeof(m->strs));
+        }
+        break;
+    case DBR_CTRL_DOUBLE:
+        m->precision = ((struct dbr_ctrl_double *)args.dbr)->precision;
+        COPY_UNITS(dbr_ctrl_double);
+        break;
+    case DBR_CTRL_FLOAT:
+        m->precision = ((struct dbr_ctrl_float *)args.dbr)->precision;
+        COPY_UNITS(dbr_ctrl_float);
+        break;
+    case DBR_CTRL_SHORT: COPY_UNITS(dbr_ctrl_short); break;
+    case DBR_CTRL_CHAR:  COPY_UNITS(dbr_ctrl_char); break;
+    case DBR_CTRL_LONG:  COPY_UNITS(dbr_ctrl_long); break;
+    }
+    m->units[MAX_UNITS_SIZE-1] = '\0';
+    m->updates++;
+    ppv->meta = m;
+    if (gVerb&VERB_DEBUG) printf("Metadata of %s: precision %i, units '%s', %i enum states\n",
+                                 ppv->name, m->precision, m->units, m->noStr);
+    meta_release(ppv);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	meta_subscribe
+ *
+ * Description:	Subscribe to the DBR_CTRL properties of the channel, must be
+ *              called before the value subscription so that the metadata
+ *              arrives before the first value
+ *
+ * Return(s):	CA status
+ *
+ **************************************************************************-*/
+
+int meta_subscribe (pv *ppv)
+{
+    int status;
+
+    if (ppv->dbfType == DBF_STRING) return ECA_NORMAL;  /* no DBR_CTRL_STRING */
+    status = ca_create_subscription(dbf_type_to_DBR_CTRL(ppv->dbfType),
+                                    1,
+                                    ppv->ch_id,
+                                    DBE_PROPERTY,
+                                    meta_handler,
+                                    (void*)ppv,
+                                    NULL);
+    if (status != ECA_NORMAL) meta_none(ppv);
+    return status;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	meta_hold
+ *
+ * Description:	Hold an enum update of a CA channel whose enum strings have
+ *              not arrived yet, replacing the one held before; it is passed
+ *              to fn when the metadata arrives
+ *
+ * Arg(s) In:	ppv    -  Pointer to pv structure
+ *              type, count, dbr  -  The update, as from CA
+ *              fn     -  Handler of the update
+ *
+ * Return(s):	1 - held, 0 - handle it now
+ *
+ **************************************************************************-*/
+
+int meta_hold (pv *ppv, long type, unsigned long count, const void *dbr, metaEventFunc *fn)
+{
+    size_t size = dbr_size_n(type, count);
+    metaHeld *h;
+
+    if (ppv->meta || type != DBR_TIME_ENUM || enumAsNr || !ppv->ch_id) return 0;
+    for (h = gHeld; h && h->ppv != ppv; h = h->next) ;
+    if (!h) {
+        h = calloc(1, sizeof(metaHeld));
+        if (!h) return 0;
+        h->ppv = ppv;
+        h->next = gHeld;
+        gHeld = h;
+    }
+    if (size > h->size) {
+        void *p = realloc(h->dbr, size);
+        if (!p) return 0;           /* the older held one is handed on later */
+        h->dbr = p;
+        h->size = size;
+    }
+    memcpy(h->dbr, dbr, size);
+    h->type = type;
+    h->count = count;
+    h->fn = fn;
+    if (gVerb&VERB_DETAILED) printf("Update of %s held until its enum strings arrive\n", ppv->name);
+    return 1;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	meta_val2str
+ *
+ * Description:	Convert the value element to a string, enums (unless -n)
+ *              through the cached enum strings, floating point (if -s)
+ *              with the cached precision
+ *
+ * Arg(s) In:	ppv    -  Pointer to pv structure with the DBR_TIME value
+ *              index  -  Index of the element
+ *
+ * Arg(s) Out:	type   -  DBR_TIME_STRING if the string came from the cache,
+ *                        unchanged otherwise
+ *
+ * Return(s):	Pointer to static output string
+ *
+ **************************************************************************-*/
+
+char *meta_val2str (pv *ppv, int index, int *type)
+{
+    static char str[MAX_STRING_SIZE+1];
+    struct pvMeta *m = ppv->meta;
+    const void *val_ptr = dbr_value_ptr(ppv->value, ppv->dbrType);
+
+    if (m && !enumAsNr && ppv->dbrType == DBR_TIME_ENUM)
+    {
+        dbr_enum_t val = ((dbr_enum_t *)val_ptr)[index];
+        if (val < m->noStr) {
+            *type = DBR_TIME_STRING;
+            return m->strs[val];
+        }
+    }
+    else if (m && floatAsString && ppv->dbrType == DBR_TIME_DOUBLE)
+    {
+        snprintf(str, sizeof(str), "%.*f", m->precision, ((dbr_double_t *)val_ptr)[index]);
+        *type = DBR_TIME_STRING;
+        return str;
+    }
+    else if (m && floatAsString && ppv->dbrType == DBR_TIME_FLOAT)
+    {
+        snprintf(str, sizeof(str), "%.*f", m->precision, ((dbr_float_t *)val_ptr)[index]);
+        *type = DBR_TIME_STRING;
+        return str;
+    }
+    return val2str(ppv->value, ppv->dbrType, index);
+}
@@ -0,0 +1,34 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Channel metadata cache of the epics to ado bridge
+ *
+ * The value monitors use the native DBR_TIME type of the channel (enum
+ * index, raw float). Precision, units and the enum strings come from a
+ * DBR_CTRL subscription with DBE_PROPERTY mask: CA delivers it once on
+ * every connect and again when a property changes on the IOC. Strings are
+ * produced from the cache only when the ADO parameter needs them.
+ * CA does not order the two subscriptions: an enum update which arrives
+ * before the enum strings is held, the last one per channel, and handed on
+ * when the metadata arrives. If the DBR_CTRL subscription fails, the enum
+ * updates go on as their index.
+ */
+
+#ifndef INCLpv_metah
+#define INCLpv_metah
+
+struct pvMeta
+{
+    int   precision;                            // display precision
+    char  units[MAX_UNITS_SIZE];
+    int   noStr;                                // number of enum states, 0 if not enum
+    char  strs[MAX_ENUM_STATES][MAX_ENUM_STRING_SIZE];
+    unsigned long updates;                      // number of DBR_CTRL updates received
+};
+
+/* Handles a monitor update, as the CA event handler would */
+typedef void metaEventFunc (pv *ppv, long type, unsigned long count, const void *dbr);
+
+extern int   meta_subscribe (pv *ppv);
+extern int   meta_hold (pv *ppv, long type, unsigned long count, const void *dbr, metaEventFunc *fn);
+extern char *meta_val2str (pv *ppv, int index, int *type);
+
+#endif /* ifndef INCLpv_metah */
@@ -0,0 +1,450 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* pvAccess ingestion of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Pipelined monitors, ready list drained by the event loop.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <cadef.h>
+#include <alarm.h>
+
+extern "C" {
+#include "tool_lib.h"
+}
+#include "epics2ado.h"
+#include "reactor.h"
+#include "pva_in.h"
+
+#ifdef EPICS2ADO_PVA
+#include <string>
+#include <vector>
+#include <epicsMutex.h>
+#include <epicsGuard.h>
+#include <pv/pvData.h>
+#include <pv/createRequest.h>
+#include <pva/client.h>
+
+namespace pvd = epics::pvData;
+
+// pvaChannel: the monitor of one channel, its callbacks run in the pvAccess threads
+struct pvaChannel : public pvac::ClientChannel::MonitorCallback,
+                    public pvac::ClientChannel::ConnectCallback
+{
+	pv *ppv;
+	std::string field;
+	pvac::ClientChannel chan;
+	pvac::Monitor mon;
+	bool queued;                // in the ready list, guarded by gLock
+	bool paused;                // not polled (ovf=block), event loop only
+	int connected;              // state reported by pvAccess, guarded by gLock
+	int reported;               // state passed to the bridge, event loop only
+	bool warned;                // unsupported field reported
+	std::vector<char> dbr;      // DBR_TIME value of the last update
+	unsigned long updates, overruns;
+
+	virtual void monitorEvent(const pvac::MonitorEvent& evt);
+	virtual void connectEvent(const pvac::ConnectEvent& evt);
+};
+
+static pvac::ClientProvider *gProvider = NULL;
+static std::vector<pvaChannel*> gChans;
+static std::vector<pvaChannel*> gReady;    // channels with updates or a connection change
+static epicsMutex gLock;
+static int gFd = -1;                       // eventfd, readable while gReady is not empty
+static pvaEventFunc *gEvent = NULL;
+static pvaConnFunc *gConn = NULL;
+static unsigned long gWakeups = 0, gUnsupported = 0;
+
+// ready: queue the channel for the event loop, wake it up on the first one
+static void ready(pvaChannel *ch)
+{
+	bool wake;
+	{
+		epicsGuard<epicsMutex> g(gLock);
+		if(ch->queued) return;
+		ch->queued = true;
+		wake = gReady.empty();
+		gReady.push_back(ch);
+	}
+	if(wake)
+	{
+		uint64_t one = 1;
+		if(write(gFd, &one, sizeof(one)) < 0) perror("pva eventfd");
+	}
+}
+
+void pvaChannel::monitorEvent(const pvac::MonitorEvent& evt)
+{
+	switch(evt.event) {
+	case pvac::MonitorEvent::Data:
+		ready(this);
+		break;
+	case pvac::MonitorEvent::Disconnect:
+		{
+			epicsGuard<epicsMutex> g(gLock);
+			connected = 0;
+		}
+		ready(this);
+		break;
+	case pvac::MonitorEvent::Fail:
+		fprintf(stderr, "pvAccess monitor of %s failed: %s\n", ppv->name, evt.message.c_str());
+		break;
+	case pvac::MonitorEvent::Cancel:
+		break;
+	}
+}
+
+void pvaChannel::connectEvent(const pvac::ConnectEvent& evt)
+{
+	{
+		epicsGuard<epicsMutex> g(gLock);
+		connected = evt.connected;
+	}
+	ready(this);
+}
+
+// dbr_type_of: DBR_TIME type of the pvData element type, -1: not supported
+static long dbr_type_of(pvd::ScalarType t)
+{
+	switch(t) {
+	case pvd::pvByte: case pvd::pvUByte:   return DBR_TIME_CHAR;
+	case pvd::pvShort: case pvd::pvUShort: return DBR_TIME_SHORT;
+	case pvd::pvInt: case pvd::pvUInt:     return DBR_TIME_LONG;
+	case pvd::pvFloat:                     return DBR_TIME_FLOAT;
+	case pvd::pvDouble: case pvd::pvLong: case pvd::pvULong: return DBR_TIME_DOUBLE;
+	case pvd::pvString:                    return DBR_TIME_STRING;
+	default:                               return -1;
+	}
+}
+
+// copy_array: elements of the array as T, converted by pvData only if the type differs
+template<typename T>
+static void copy_array(void *dst, const pvd::PVScalarArray &arr, unsigned long n)
+{
+	pvd::shared_vector<const T> v;
+	arr.getAs<T>(v);
+	memcpy(dst, v.data(), n*sizeof(T));
+}
+
+static void copy_strings(void *dst, const pvd::PVScalarArray &arr, unsigned long n)
+{
+	pvd::shared_vector<const std::string> v;
+	arr.getAs<std::string>(v);
+	for(unsigned long ii = 0; ii < n; ii++)
+	{
+		char *s = ((dbr_string_t *)dst)[ii];
+		strncpy(s, v[ii].c_str(), MAX_STRING_SIZE-1);
+		s[MAX_STRING_SIZE-1] = '\0';
+	}
+}
+
+static void copy_scalar(void *dst, long type, const pvd::PVScalar &sc)
+{
+	switch(type) {
+	case DBR_TIME_CHAR:   *(dbr_char_t *)dst = sc.getAs<pvd::uint8>(); break;
+	case DBR_TIME_SHORT:  *(dbr_short_t *)dst = sc.getAs<pvd::int16>(); break;
+	case DBR_TIME_LONG:   *(dbr_long_t *)dst = sc.getAs<pvd::int32>(); break;
+	case DBR_TIME_FLOAT:  *(dbr_float_t *)dst = sc.getAs<float>(); break;
+	case DBR_TIME_DOUBLE: *(dbr_double_t *)dst = sc.getAs<double>(); break;
+	case DBR_TIME_STRING:
+		strncpy((char *)dst, sc.getAs<std::string>().c_str(), MAX_STRING_SIZE-1);
+		((char *)dst)[MAX_STRING_SIZE-1] = '\0';
+		break;
+	}
+}
+
+// value_header: room for the value in the DBR buffer, alarm and timestamp filled in
+static void *value_header(pvaChannel *ch, const pvd::PVStructure &root, long type, unsigned long count)
+{
+	struct dbr_time_double *h;
+	pvd::PVInt::const_shared_pointer sevr(root.getSubField<pvd::PVInt>("alarm.severity"));
+	pvd::PVInt::const_shared_pointer stat(root.getSubField<pvd::PVInt>("alarm.status"));
+	pvd::PVLong::const_shared_pointer sec(root.getSubField<pvd::PVLong>("timeStamp.secondsPastEpoch"));
+	pvd::PVInt::const_shared_pointer nsec(root.getSubField<pvd::PVInt>("timeStamp.nanoseconds"));
+
+	ch->dbr.resize(dbr_size_n(type, count ? count : 1));
+	h = (struct dbr_time_double *)&ch->dbr[0];
+	h->severity = sevr ? sevr->get() : NO_ALARM;
+	// the pvAccess alarm status (NONE, DEVICE, ..., UNDEFINED, CLIENT) has no CA equivalent
+	if(h->severity == NO_ALARM) h->status = NO_ALARM;
+	else if(stat && stat->get() == 6) h->status = UDF_ALARM;
+	else if(stat && stat->get() == 7) h->status = COMM_ALARM;
+	else h->status = READ_ALARM;
+	if(sec && sec->get() > POSIX_TIME_AT_EPICS_EPOCH)
+	{
+		h->stamp.secPastEpoch = sec->get() - POSIX_TIME_AT_EPICS_EPOCH;
+		h->stamp.nsec = nsec ? nsec->get() : 0;
+	}
+	else epicsTimeGetCurrent(&h->stamp);
+	return dbr_value_ptr(h, type);
+}
+
+// convert: the field of the last polled update as DBR_TIME value in ch->dbr,
+// return 0 on success, 1 if the field is missing or of an unsupported type
+static int convert(pvaChannel *ch, long *type, unsigned long *count)
+{
+	const pvd::PVStructure &root = *ch->mon.root;
+	pvd::PVScalarArray::const_shared_pointer arr(root.getSubField<pvd::PVScalarArray>(ch->field));
+	pvd::PVScalar::const_shared_pointer sc(root.getSubField<pvd::PVScalar>(ch->field));
+	pvd::PVInt::const_shared_pointer index(root.getSubField<pvd::PVInt>(ch->field + ".index"));
+	void *val;
+
+	if(arr)
+	{
+		*type = dbr_type_of(arr->getScalarArray()->getElementType());
+		*count = arr->getLength();
+		if(ch->ppv->reqElems && *count > ch->ppv->reqElems) *count = ch->ppv->reqElems;
+		if(*type < 0) return 1;
+		val = value_header(ch, root, *type, *count);
+		switch(*type) {
+		case DBR_TIME_CHAR:   copy_array<pvd::uint8>(val, *arr, *count); break;
+		case DBR_TIME_SHORT:  copy_array<pvd::int16>(val, *arr, *count); break;
+		case DBR_TIME_LONG:   copy_array<pvd::int32>(val, *arr, *count); break;
+		case DBR_TIME_FLOAT:  copy_array<float>(val, *arr, *count); break;
+		case DBR_TIME_DOUBLE: copy_array<double>(val, *arr, *count); break;
+		case DBR_TIME_STRING: copy_strings(val, *arr, *count); break;
+		}
+	}
+	else if(sc)
+	{
+		*type = dbr_type_of(sc->getScalar()->getScalarType());
+		*count = 1;
+		if(*type < 0) return 1;
+		val = value_header(ch, root, *type, 1);
+		copy_scalar(val, *type, *sc);
+	}
+	else if(index)      // NTEnum
+	{
+		pvd::PVStringArray::const_shared_pointer choices(
+			root.getSubField<pvd::PVStringArray>(ch->field + ".choices"));
+		pvd::PVStringArray::const_svector strs;
+		pvd::int32 ii = index->get();
+		if(choices) strs = choices->view();
+		*count = 1;
+		if(enumAsNr || ii < 0 || (size_t)ii >= strs.size())
+		{
+			*type = DBR_TIME_ENUM;
+			val = value_header(ch, root, *type, 1);
+			*(dbr_enum_t *)val = ii;
+		}
+		else
+		{
+			*type = DBR_TIME_STRING;
+			val = value_header(ch, root, *type, 1);
+			strncpy((char *)val, strs[ii].c_str(), MAX_STRING_SIZE-1);
+			((char *)val)[MAX_STRING_SIZE-1] = '\0';
+		}
+	}
+	else return 1;
+	return 0;
+}
+
+// take: pass at most PVA_POLL_BUDGET updates of the channel to the bridge,
+// return 1 if more are waiting
+static int take(pvaChannel *ch)
+{
+	long type;
+	unsigned long count;
+	int n;
+
+	for(n = 0; n < PVA_POLL_BUDGET; n++)
+	{
+		if(!ch->mon.poll()) return 0;   // acknowledges the previous update
+		ch->updates++;
+		if(!ch->mon.overrun.isEmpty()) ch->overruns++;
+		if(convert(ch, &type, &count))
+		{
+			gUnsupported++;
+			if(!ch->warned) fprintf(stderr, "pvAccess channel %s: field '%s' missing or not supported\n",
+			                        ch->ppv->name, ch->field.c_str());
+			ch->warned = true;
+			continue;
+		}
+		ch->ppv->dbfType = type - DBR_TIME_STRING;
+		ch->ppv->dbrType = type;
+		ch->ppv->nElems = count;
+		gEvent(ch->ppv, type, count, &ch->dbr[0]);
+	}
+	return 1;
+}
+
+// drain: eventfd callback in the event loop, take the updates of the ready channels
+static void drain(void *arg, int fd)
+{
+	std::vector<pvaChannel*> chans;
+	std::vector<int> states;
+	uint64_t n;
+
+	if(read(gFd, &n, sizeof(n)) < 0) return;
+	gWakeups++;
+	{
+		epicsGuard<epicsMutex> g(gLock);
+		chans.swap(gReady);
+		for(size_t ii = 0; ii < chans.size(); ii++)
+		{
+			chans[ii]->queued = false;
+			states.push_back(chans[ii]->connected);
+		}
+	}
+	for(size_t ii = 0; ii < chans.size(); ii++)
+	{
+		pvaChannel *ch = chans[ii];
+		if(states[ii] != ch->reported)
+		{
+			ch->reported = states[ii];
+			gConn(ch->ppv, ch->reported);
+		}
+		if(ch->paused) continue;        // resumed by pva_pause
+		try {
+			if(take(ch)) ready(ch);     // the other channels go first
+		}
+		catch(std::exception& e) {
+			fprintf(stderr, "pvAccess channel %s: %s\n", ch->ppv->name, e.what());
+		}
+	}
+}
+
+static pvaChannel *channel_of(const pv *ppv)
+{
+	for(size_t ii = 0; ii < gChans.size(); ii++)
+		if(gChans[ii]->ppv == ppv) return gChans[ii];
+	return NULL;
+}
+#endif /* EPICS2ADO_PVA */
+
+/*+**************************************************************************
+ *
+ * Function:	pva_init
+ *
+ * Description:	Create the pvAccess client and the wakeup of the event loop
+ *
+ * Arg(s) In:	event  -  Called with each update
+ *              conn   -  Called when a channel connects or disconnects
+ *
+ * Return(s):	0 - success, 1 - error or built without pvAccess
+ *
+ **************************************************************************-*/
+
+extern "C" int pva_init(pvaEventFunc *event, pvaConnFunc *conn)
+{
+#ifdef EPICS2ADO_PVA
+	gEvent = event;
+	gConn = conn;
+	gFd = eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+	if(gFd < 0 || reactor_add_fd(gFd, drain, NULL)) {perror("pva eventfd"); return 1;}
+	try {
+		gProvider = new pvac::ClientProvider("pva");
+	}
+	catch(std::exception& e) {
+		fprintf(stderr, "pvAccess client: %s\n", e.what());
+		return 1;
+	}
+	return 0;
+#else
+	fprintf(stderr, "src=pva: the bridge was built without pvAccess (EPICS2ADO_PVA)\n");
+	return 1;
+#endif
+}
+
+/*+**************************************************************************
+ *
+ * Function:	pva_subscribe
+ *
+ * Description:	Connect the channel and start its pipelined monitor
+ *
+ * Arg(s) In:	ppv    -  Channel, name and reqElems set
+ *              field  -  Field of the value, NULL: 'value'
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+extern "C" int pva_subscribe(pv *ppv, const char *field)
+{
+#ifdef EPICS2ADO_PVA
+	pvaChannel *ch = new pvaChannel();
+	char request[256];
+
+	ch->ppv = ppv;
+	ch->field = field ? field : "value";
+	ch->queued = ch->paused = ch->warned = false;
+	ch->connected = ch->reported = 0;
+	ch->updates = ch->overruns = 0;
+	// only the top level field of the value, alarm and timeStamp are sent
+	snprintf(request, sizeof(request), "field(%.*s,alarm,timeStamp)record[pipeline=true,queueSize=%d]",
+	         (int)strcspn(ch->field.c_str(), "."), ch->field.c_str(), PVA_QUEUE_SIZE);
+	try {
+		ch->chan = gProvider->connect(ppv->name);
+		ch->chan.addConnectListener(ch);
+		ch->mon = ch->chan.monitor(ch, pvd::createRequest(request));
+	}
+	catch(std::exception& e) {
+		fprintf(stderr, "pvAccess error %s occurred while trying to monitor '%s'.\n", e.what(), ppv->name);
+		delete ch;
+		return 1;
+	}
+	gChans.push_back(ch);
+	return 0;
+#else
+	return 1;
+#endif
+}
+
+// pva_pause - stop taking the updates of the channel; the server stops
+// sending when PVA_QUEUE_SIZE of them are not acknowledged
+extern "C" void pva_pause(pv *ppv, int pause)
+{
+#ifdef EPICS2ADO_PVA
+	pvaChannel *ch = channel_of(ppv);
+	if(!ch) return;
+	ch->paused = pause;
+	if(!pause) ready(ch);
+#endif
+}
+
+extern "C" int pva_connected(const pv *ppv)
+{
+#ifdef EPICS2ADO_PVA
+	pvaChannel *ch = channel_of(ppv);
+	return ch && ch->reported;
+#else
+	return 0;
+#endif
+}
+
+extern "C" void pva_report(FILE *stream)
+{
+#ifdef EPICS2ADO_PVA
+	unsigned long updates = 0, overruns = 0;
+	int connected = 0;
+	if(gChans.empty()) return;
+	for(size_t ii = 0; ii < gChans.size(); ii++)
+	{
+		updates += gChans[ii]->updates;
+		overruns += gChans[ii]->overruns;
+		connected += gChans[ii]->reported;
+	}
+	fprintf(stream, "pva: channels %u, connected %i, updates %lu, overruns %lu, unsupported %lu, wakeups %lu\n",
+	        (unsigned)gChans.size(), connected, updates, overruns, gUnsupported, gWakeups);
+#endif
+}
+
+extern "C" void pva_close(void)
+{
+#ifdef EPICS2ADO_PVA
+	for(size_t ii = 0; ii < gChans.size(); ii++)
+	{
+		gChans[ii]->mon.cancel();
+		gChans[ii]->chan.removeConnectListener(gChans[ii]);
+		delete gChans[ii];
+	}
+	gChans.clear();
+	delete gProvider;
+	gProvider = NULL;
+	if(gFd >= 0) {reactor_remove_fd(gFd); close(gFd);}
+	gFd = -1;
+#endif
+}
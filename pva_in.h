@@ -0,0 +1,50 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* pvAccess ingestion of the epics to ado bridge (src=pva map option)
+ *
+ * The channels of the map records with src=pva are monitored over pvAccess
+ * instead of Channel Access; their updates go through the same path as the
+ * CA events: reduction, queueing, conversion and the ADO writes.
+ * The monitors are pipelined: the server sends at most PVA_QUEUE_SIZE
+ * updates ahead of the acknowledgements, an update is acknowledged when the
+ * event loop takes it. The pvAccess threads only note the channel as ready
+ * and wake the event loop through an eventfd; the loop takes at most
+ * PVA_POLL_BUDGET updates of a channel per wakeup, so the bridge sets the
+ * pace and a stalled or paused (ovf=block) channel throttles the server.
+ * An update is copied once, from the pvData array into the DBR_TIME value.
+ *   field=<path>  field of the value, default 'value': NTScalar and
+ *                 NTScalarArray, NTEnum (the choice string, the index with
+ *                 -n), a column of an NTTable: field=value.<column>
+ * Element types: double, float, int, short, byte as the DBR types, the
+ * unsigned ones as the signed DBR type of their size, long and ulong as
+ * double, string as DBR_STRING (MAX_STRING_SIZE characters).
+ * Needs EPICS 7: built with EPICS2ADO_PVA defined and linked with pvAccess
+ * and pvData, otherwise pva_init() fails.
+ */
+
+#ifndef INCLpva_inh
+#define INCLpva_inh
+
+#define PVA_QUEUE_SIZE 4            /* Updates in flight per monitor */
+#define PVA_POLL_BUDGET 4           /* Updates taken per channel and wakeup */
+
+/* Called in the event loop thread: update of the channel, DBR_TIME value */
+typedef void pvaEventFunc (pv *ppv, long type, unsigned long count, const void *dbr);
+/* Called in the event loop thread: channel connected or disconnected */
+typedef void pvaConnFunc (pv *ppv, int connected);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int  pva_init (pvaEventFunc *event, pvaConnFunc *conn);
+extern int  pva_subscribe (pv *ppv, const char *field);
+extern void pva_pause (pv *ppv, int pause);
+extern int  pva_connected (const pv *ppv);
+extern void pva_report (FILE *stream);
+extern void pva_close (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef INCLpva_inh */
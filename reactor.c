@@ -0,0 +1,215 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Single threaded event loop of the epics to ado bridge
+ *
+ * version v01 2026-10-19. epoll set with CA fds, ADO fds and timerfd timers.
+ * version v02 2026-10-19. Write interest of an fd.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include "reactor.h"
+
+/* Handler of one fd, indexed by the fd */
+typedef struct reactorHandler
+{
+    reactorCB *cb;
+    void *arg;
+    int   isTimer;
+} reactorHandler;
+
+static int gEpollFd = -1;
+static reactorHandler *gHandlers = NULL;
+static int gNHandlers = 0;
+static int gStop = 0;
+
+int reactor_init (void)
+{
+    gEpollFd = epoll_create(REACTOR_MAX_EVENTS);
+    if (gEpollFd < 0) {
+        perror("epoll_create");
+        return 1;
+    }
+    return 0;
+}
+
+static int reactor_register (int fd, reactorCB *cb, void *arg, int isTimer)
+{
+    struct epoll_event ev;
+
+    if (fd >= gNHandlers) {
+        int n = fd + 16;
+        reactorHandler *h = realloc(gHandlers, n*sizeof(reactorHandler));
+        if (!h) return 1;
+        memset(h + gNHandlers, 0, (n - gNHandlers)*sizeof(reactorHandler));
+        gHandlers = h;
+        gNHandlers = n;
+    }
+    gHandlers[fd].cb = cb;
+    gHandlers[fd].arg = arg;
+    gHandlers[fd].isTimer = isTimer;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(gEpollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl");
+        gHandlers[fd].cb = NULL;
+        return 1;
+    }
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	reactor_add_fd
+ *
+ * Description:	Call cb(arg, fd) from the loop whenever fd is readable
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int reactor_add_fd (int fd, reactorCB *cb, void *arg)
+{
+    return reactor_register(fd, cb, arg, 0);
+}
+
+int reactor_remove_fd (int fd)
+{
+    if (fd < gNHandlers) gHandlers[fd].cb = NULL;
+    return epoll_ctl(gEpollFd, EPOLL_CTL_DEL, fd, NULL) < 0;
+}
+
+// reactor_want_write - also call the callback of fd when it is writable (on) or not (off), 0 - success
+int reactor_want_write (int fd, int on)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = on ? EPOLLIN|EPOLLOUT : EPOLLIN;
+    ev.data.fd = fd;
+    return epoll_ctl(gEpollFd, EPOLL_CTL_MOD, fd, &ev) < 0;
+}
+
+static void seconds_to_timespec (double t, struct timespec *ts)
+{
+    ts->tv_sec = (time_t) t;
+    ts->tv_nsec = (long) ((t - ts->tv_sec)*1.e9);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	reactor_set_timer
+ *
+ * Description:	(Re)arm the timer
+ *
+ * Arg(s) In:	tfd     -  Timer, as returned by reactor_add_timer
+ *              delay   -  First expiration, s from now, 0: disarm the timer
+ *              period  -  Period of the following expirations, s, 0: one-shot
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int reactor_set_timer (int tfd, double delay, double period)
+{
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    seconds_to_timespec(delay, &its.it_value);
+    if (delay > 0. && its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0)
+        its.it_value.tv_nsec = 1;       /* zero would disarm */
+    seconds_to_timespec(period, &its.it_interval);
+    if (timerfd_settime(tfd, 0, &its, NULL) < 0) {
+        perror("timerfd_settime");
+        return 1;
+    }
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	reactor_add_timer
+ *
+ * Description:	Create a timer calling cb(arg, tfd) from the loop
+ *
+ * Arg(s) In:	delay   -  First expiration, s from now, 0: created disarmed
+ *              period  -  Period of the following expirations, s, 0: one-shot
+ *
+ * Return(s):	Timer file descriptor, -1 on error
+ *
+ **************************************************************************-*/
+
+int reactor_add_timer (double delay, double period, reactorCB *cb, void *arg)
+{
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (tfd < 0) {
+        perror("timerfd_create");
+        return -1;
+    }
+    if (reactor_register(tfd, cb, arg, 1) || reactor_set_timer(tfd, delay, period)) {
+        close(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+void reactor_remove_timer (int tfd)
+{
+    reactor_remove_fd(tfd);
+    close(tfd);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	reactor_run
+ *
+ * Description:	Dispatch fd events and timers until reactor_stop() is called.
+ *              work() is called after each batch of events; while it
+ *              reports more work the loop does not block in epoll_wait()
+ *
+ * Return(s):	0 - stopped, 1 - epoll error
+ *
+ **************************************************************************-*/
+
+int reactor_run (reactorWork *work)
+{
+    struct epoll_event evs[REACTOR_MAX_EVENTS];
+    int busy = work ? work() : 0;
+
+    gStop = 0;
+    while (!gStop)
+    {
+        int ii, n = epoll_wait(gEpollFd, evs, REACTOR_MAX_EVENTS, busy ? 0 : -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return 1;
+        }
+        for (ii = 0; ii < n; ii++)
+        {
+            int fd = evs[ii].data.fd;
+            reactorHandler *h;
+            if (fd >= gNHandlers || !gHandlers[fd].cb) continue;
+            h = &gHandlers[fd];
+            if (h->isTimer) {
+                uint64_t expirations;
+                if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+                    continue;
+            }
+            h->cb(h->arg, fd);
+        }
+        busy = work ? work() : 0;
+    }
+    return 0;
+}
+
+void reactor_stop (void)
+{
+    gStop = 1;
+}
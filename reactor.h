@@ -0,0 +1,41 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Single threaded event loop of the epics to ado bridge
+ *
+ * One epoll set multiplexes the CA file descriptors (ca_add_fd_registration),
+ * the file descriptors of the ADO side and timerfd based timers. The loop
+ * blocks in epoll_wait() while there is nothing to do, there is no polling
+ * and no sleep based wakeup.
+ */
+
+#ifndef INCLreactorh
+#define INCLreactorh
+
+#define REACTOR_MAX_EVENTS 64   /* Max events handled per epoll_wait() */
+
+/* Called when the fd is readable, or writable if asked for with
+ * reactor_want_write (for timers: when the timer expired) */
+typedef void reactorCB (void *arg, int fd);
+
+/* Called once per loop iteration after the fd callbacks,
+ * returns nonzero if it has more work to do */
+typedef int reactorWork (void);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern int  reactor_init (void);
+extern int  reactor_add_fd (int fd, reactorCB *cb, void *arg);
+extern int  reactor_remove_fd (int fd);
+extern int  reactor_want_write (int fd, int on);
+extern int  reactor_add_timer (double delay, double period, reactorCB *cb, void *arg);
+extern int  reactor_set_timer (int tfd, double delay, double period);
+extern void reactor_remove_timer (int tfd);
+extern int  reactor_run (reactorWork *work);
+extern void reactor_stop (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ifndef INCLreactorh */
@@ -0,0 +1,199 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Waveform reduction of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Decimation, block average, envelope, statistics.
+ * version v02 2026-10-19. Standard deviation in two passes.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <cadef.h>
+
+#include "xf.h"
+#include "reduce.h"
+
+static const char *gReduceNames[] = {"none", "dec", "avg", "env", "stats", NULL};
+
+/*+**************************************************************************
+ *
+ * Function:	reduce_parse
+ *
+ * Description:	Interpret the red= option of the map
+ *
+ * Arg(s) In:	spec  -  <kind>[:<n>]
+ *
+ * Arg(s) Out:	kind  -  ReduceT
+ *              n     -  Block size or stride, 1 if not given
+ *
+ * Return(s):	0 - success, 1 - invalid spec
+ *
+ **************************************************************************-*/
+
+int reduce_parse (const char *spec, int *kind, unsigned long *n)
+{
+    const char *colon = strchr(spec, ':');
+    size_t len = colon ? (size_t)(colon - spec) : strlen(spec);
+    int ii;
+
+    for (ii = redDecimate; gReduceNames[ii]; ii++)
+        if (strlen(gReduceNames[ii]) == len && strncmp(gReduceNames[ii], spec, len) == 0) break;
+    if (!gReduceNames[ii]) return 1;
+    *kind = ii;
+    *n = 1;
+    if (colon && (sscanf(colon + 1, "%lu", n) != 1 || *n == 0)) return 1;
+    if (ii != redStats && *n == 1 && !colon) return 1;    /* the block size is required */
+    return 0;
+}
+
+static double block_sum (const double *restrict v, unsigned long len)
+{
+    double s[RED_LANES] = {0., 0., 0., 0.}, sum;
+    unsigned long ii;
+    int k;
+
+    for (ii = 0; ii + RED_LANES <= len; ii += RED_LANES)
+        for (k = 0; k < RED_LANES; k++) s[k] += v[ii+k];
+    sum = (s[0] + s[1]) + (s[2] + s[3]);
+    for (; ii < len; ii++) sum += v[ii];
+    return sum;
+}
+
+static void block_minmax (const double *restrict v, unsigned long len, double *min, double *max)
+{
+    double lo[RED_LANES], hi[RED_LANES];
+    unsigned long ii;
+    int k;
+
+    for (k = 0; k < RED_LANES; k++) lo[k] = hi[k] = v[0];
+    for (ii = 0; ii + RED_LANES <= len; ii += RED_LANES)
+        for (k = 0; k < RED_LANES; k++) {
+            lo[k] = v[ii+k] < lo[k] ? v[ii+k] : lo[k];
+            hi[k] = v[ii+k] > hi[k] ? v[ii+k] : hi[k];
+        }
+    for (; ii < len; ii++) {
+        lo[0] = v[ii] < lo[0] ? v[ii] : lo[0];
+        hi[0] = v[ii] > hi[0] ? v[ii] : hi[0];
+    }
+    for (k = 1; k < RED_LANES; k++) {
+        if (lo[k] < lo[0]) lo[0] = lo[k];
+        if (hi[k] > hi[0]) hi[0] = hi[k];
+    }
+    *min = lo[0];
+    *max = hi[0];
+}
+
+/* Mean, RMS, min, max and standard deviation. The deviation takes a second
+ * pass over the deviations from the mean (corrected two-pass algorithm):
+ * sumsq/len - mean*mean cancels catastrophically for a small spread on a
+ * large offset, e.g. a BPM sum signal. */
+static void stats (const double *restrict v, unsigned long len, double *out)
+{
+    double s[RED_LANES] = {0., 0., 0., 0.}, q[RED_LANES] = {0., 0., 0., 0.};
+    double d[RED_LANES] = {0., 0., 0., 0.}, dd[RED_LANES] = {0., 0., 0., 0.};
+    double sum, sumsq, mean, dev, devsq, var;
+    unsigned long ii;
+    int k;
+
+    for (ii = 0; ii + RED_LANES <= len; ii += RED_LANES)
+        for (k = 0; k < RED_LANES; k++) {
+            s[k] += v[ii+k];
+            q[k] += v[ii+k]*v[ii+k];
+        }
+    sum = (s[0] + s[1]) + (s[2] + s[3]);
+    sumsq = (q[0] + q[1]) + (q[2] + q[3]);
+    for (; ii < len; ii++) {
+        sum += v[ii];
+        sumsq += v[ii]*v[ii];
+    }
+    mean = sum/len;
+    for (ii = 0; ii + RED_LANES <= len; ii += RED_LANES)
+        for (k = 0; k < RED_LANES; k++) {
+            d[k] += v[ii+k] - mean;
+            dd[k] += (v[ii+k] - mean)*(v[ii+k] - mean);
+        }
+    dev = (d[0] + d[1]) + (d[2] + d[3]);
+    devsq = (dd[0] + dd[1]) + (dd[2] + dd[3]);
+    for (; ii < len; ii++) {
+        dev += v[ii] - mean;
+        devsq += (v[ii] - mean)*(v[ii] - mean);
+    }
+    var = (devsq - dev*dev/len)/len;    /* dev: rounding error of the mean */
+    out[0] = mean;
+    out[1] = sqrt(sumsq/len);
+    block_minmax(v, len, &out[2], &out[3]);
+    out[4] = var > 0. ? sqrt(var) : 0.;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	reduce_event
+ *
+ * Description:	Reduce the CA event
+ *
+ * Arg(s) In:	kind, n   -  Reduction, see reduce_parse()
+ *              dbrType   -  DBR_TIME type of the event
+ *              count     -  Number of elements of the event
+ *              dbr       -  Value of the event
+ *
+ * Arg(s) Out:	outCount  -  Number of elements of the result
+ *
+ * Return(s):	Pointer to a static DBR_TIME_DOUBLE value, valid until the
+ *              next call, NULL if the event cannot be reduced (strings,
+ *              no elements, no memory)
+ *
+ **************************************************************************-*/
+
+const void *reduce_event (int kind, unsigned long n, long dbrType,
+                          unsigned long count, const void *dbr, unsigned long *outCount)
+{
+    static struct dbr_time_double *res = NULL;
+    static unsigned long resSize = 0;
+    const struct dbr_time_double *hdr = dbr;   /* the header is the same for all DBR_TIME */
+    unsigned long nBlocks = (count + n - 1)/n, m, jj;
+    const double *v;
+    double *out;
+
+    if (count == 0 || dbrType == DBR_TIME_STRING) return NULL;
+    switch (kind) {
+    case redDecimate: case redAverage: m = nBlocks; break;
+    case redEnvelope: m = 2*nBlocks; break;
+    case redStats:    m = RED_NSTATS; break;
+    default: return NULL;
+    }
+    if (m > resSize) {
+        void *p = realloc(res, dbr_size_n(DBR_TIME_DOUBLE, m));
+        if (!p) return NULL;
+        res = p;
+        resSize = m;
+    }
+    v = xf_input(dbr, dbrType, count);
+    if (!v) return NULL;
+    out = &res->value;
+    switch (kind) {
+    case redDecimate:
+        for (jj = 0; jj < nBlocks; jj++) out[jj] = v[jj*n];
+        break;
+    case redAverage:
+        for (jj = 0; jj < nBlocks; jj++) {
+            unsigned long len = count - jj*n < n ? count - jj*n : n;
+            out[jj] = block_sum(v + jj*n, len)/len;
+        }
+        break;
+    case redEnvelope:
+        for (jj = 0; jj < nBlocks; jj++) {
+            unsigned long len = count - jj*n < n ? count - jj*n : n;
+            block_minmax(v + jj*n, len, &out[jj], &out[nBlocks + jj]);
+        }
+        break;
+    case redStats:
+        stats(v, count, out);
+        break;
+    }
+    res->status = hdr->status;
+    res->severity = hdr->severity;
+    res->stamp = hdr->stamp;
+    *outCount = m;
+    return res;
+}
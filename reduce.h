@@ -0,0 +1,30 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Waveform reduction of the epics to ado bridge (red=<kind>[:<n>] in the csv map)
+ *
+ * A reduced channel is shrunk in the CA event path, before it is queued, to
+ * a DBR_TIME_DOUBLE array (same status, severity and timestamp):
+ *   dec:<n>  every n-th element
+ *   avg:<n>  average of each block of n elements
+ *   env:<n>  minima of the blocks of n elements, followed by their maxima
+ *   stats    mean, rms, min, max, standard deviation
+ * out=<p1>;<p2>... names further ADO parameters of the record: the reduced
+ * array is split evenly between the mapped parameter and them, so e.g.
+ * env with out=<max> writes the minima and the maxima to separate
+ * parameters, stats with out=<rms>;<min>;<max>;<std> one value to each.
+ * The kernels work on the elements converted to double, with independent
+ * partial sums per lane (RED_LANES), see the array kernels of xf.c.
+ */
+
+#ifndef INCLreduceh
+#define INCLreduceh
+
+#define RED_LANES 4                 /* Partial sums per reduction */
+#define RED_NSTATS 5                /* Values of the stats reduction */
+
+typedef enum { redNone, redDecimate, redAverage, redEnvelope, redStats } ReduceT;
+
+extern int reduce_parse (const char *spec, int *kind, unsigned long *n);
+extern const void *reduce_event (int kind, unsigned long n, long dbrType,
+                                 unsigned long count, const void *dbr, unsigned long *outCount);
+
+#endif /* ifndef INCLreduceh */
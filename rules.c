@@ -0,0 +1,269 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Pattern rules of the epics to ado map
+ *
+ * version v01 2026-10-19. Wildcard patterns in a prefix trie, $n substitution.
+ * version v02 2026-10-19. Lookup states after a '*' memoized, matching is polynomial.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rules.h"
+
+/* Trie node: one character of the patterns sharing the prefix */
+typedef struct ruleNode
+{
+    char c;                         // literal character
+    char wild;                      // 0: literal, '*' or '?'
+    int  child;                     // first child, -1: none
+    int  sibling;                   // next child of the parent, -1: none
+    int  id;                        // pattern ending here, -1: none
+} ruleNode;
+
+static ruleNode *gNodes = NULL;     // gNodes[0] is the root
+static int gNNodes = 0, gNodesSize = 0;
+
+/* Lookup state (node, offset in the name) entered after a '*', explored by this lookup */
+typedef struct ruleState
+{
+    int node;
+    int offset;
+    unsigned gen;                   // lookup which explored it
+} ruleState;
+
+static ruleState *gStates = NULL;   // open addressing, gStatesSize a power of 2
+static int gNStates = 0, gStatesSize = 0;
+static unsigned gGen = 0;           // current lookup
+static const char *gName = NULL;    // name of the current lookup
+
+static int node_new (char c, char wild)
+{
+    ruleNode *n;
+    if (gNNodes >= gNodesSize)
+    {
+        int size = gNodesSize ? 2*gNodesSize : 256;
+        ruleNode *p;
+        if (size > RULE_MAX_NODES) return -1;
+        p = realloc(gNodes, size*sizeof(ruleNode));
+        if (!p) return -1;
+        gNodes = p;
+        gNodesSize = size;
+    }
+    n = &gNodes[gNNodes];
+    n->c = c;
+    n->wild = wild;
+    n->child = n->sibling = n->id = -1;
+    return gNNodes++;
+}
+
+/* Child of the node for the pattern character, created if missing */
+static int child_of (int node, char c, char wild)
+{
+    int ch, last = -1;
+    for (ch = gNodes[node].child; ch >= 0; ch = gNodes[ch].sibling)
+    {
+        if (gNodes[ch].wild == wild && (wild || gNodes[ch].c == c)) return ch;
+        last = ch;
+    }
+    ch = node_new(c, wild);
+    if (ch < 0) return -1;
+    if (last < 0) gNodes[node].child = ch;
+    else          gNodes[last].sibling = ch;
+    return ch;
+}
+
+int rules_is_pattern (const char *s)
+{
+    return strpbrk(s, "*?") != NULL;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	rules_add
+ *
+ * Description:	Add the pattern or literal name to the trie
+ *
+ * Arg(s) In:	pattern  -  PV name with wildcards '*' and '?', or without
+ *              id       -  Returned by rules_match, >= 0
+ *
+ * Return(s):	0 - success, 1 - too many wildcards or trie nodes
+ *
+ **************************************************************************-*/
+
+int rules_add (const char *pattern, int id)
+{
+    int node = gNNodes ? 0 : node_new('\0', 0);
+    int nWild = 0;
+    const char *p;
+
+    if (node < 0) return 1;
+    for (p = pattern; *p; p++)
+    {
+        char wild = *p == '*' || *p == '?' ? *p : 0;
+        if (wild && ++nWild > RULE_MAX_CAPTURES) return 1;
+        node = child_of(node, wild ? '\0' : *p, wild);
+        if (node < 0) return 1;
+    }
+    if (gNodes[node].id < 0 || id < gNodes[node].id) gNodes[node].id = id;
+    return 0;
+}
+
+static size_t state_slot (int node, int offset, int mask)
+{
+    return ((unsigned)node*2654435761u ^ (unsigned)offset*40503u) & mask;
+}
+
+/* Mark the state explored, return 1 if it was explored before by this lookup.
+ * Exploring it again cannot find a lower id: its ids were compared then. */
+static int state_seen (int node, int offset)
+{
+    ruleState *st;
+    size_t slot;
+
+    if (2*(gNStates + 1) > gStatesSize)   /* grow, keep the states of this lookup */
+    {
+        int size = gStatesSize ? 2*gStatesSize : 1024, ii;
+        ruleState *p = calloc(size, sizeof(ruleState));
+        if (!p) return 0;           /* explored again, only slower */
+        for (ii = 0; ii < gStatesSize; ii++)
+        {
+            ruleState *o = &gStates[ii];
+            if (o->gen != gGen) continue;
+            for (slot = state_slot(o->node, o->offset, size - 1); p[slot].gen == gGen;
+                 slot = (slot + 1) & (size - 1)) ;
+            p[slot] = *o;
+        }
+        free(gStates);
+        gStates = p;
+        gStatesSize = size;
+    }
+    for (slot = state_slot(node, offset, gStatesSize - 1); gStates[slot].gen == gGen;
+         slot = (slot + 1) & (gStatesSize - 1))
+        if (gStates[slot].node == node && gStates[slot].offset == offset) return 1;
+    st = &gStates[slot];
+    st->node = node;
+    st->offset = offset;
+    st->gen = gGen;
+    gNStates++;
+    return 0;
+}
+
+/* Walk the trie along s, keep the match with the lowest id in best */
+static void match_node (int node, const char *s, int depth, ruleMatch *cur, int *bestId, ruleMatch *best)
+{
+    int ch;
+    size_t k, len;
+
+    if (*s == '\0' && gNodes[node].id >= 0 && (*bestId < 0 || gNodes[node].id < *bestId))
+    {
+        *bestId = gNodes[node].id;
+        *best = *cur;
+        best->nCaps = depth;
+    }
+    for (ch = gNodes[node].child; ch >= 0; ch = gNodes[ch].sibling)
+    {
+        const ruleNode *c = &gNodes[ch];
+        if (!c->wild) {
+            if (*s == c->c) match_node(ch, s + 1, depth, cur, bestId, best);
+            continue;
+        }
+        cur->cap[depth] = s;
+        if (c->wild == '?') {
+            if (!*s) continue;
+            cur->capLen[depth] = 1;
+            match_node(ch, s + 1, depth + 1, cur, bestId, best);
+            continue;
+        }
+        for (k = 0, len = strlen(s); k <= len; k++)
+        {
+            if (state_seen(ch, s + k - gName)) continue;
+            cur->capLen[depth] = k;
+            match_node(ch, s + k, depth + 1, cur, bestId, best);
+        }
+    }
+}
+
+/*+**************************************************************************
+ *
+ * Function:	rules_match
+ *
+ * Description:	Find the pattern matching the name. A state of the walk
+ *              after a '*' is explored once, so the cost is bounded by the
+ *              trie nodes times the name length, not exponential in the
+ *              number of stars
+ *
+ * Arg(s) In:	name  -  PV name
+ *
+ * Arg(s) Out:	m     -  Captured text, pointers into name
+ *
+ * Return(s):	Id of the matching pattern with the lowest id, -1: no match
+ *
+ **************************************************************************-*/
+
+int rules_match (const char *name, ruleMatch *m)
+{
+    ruleMatch cur;
+    int bestId = -1;
+
+    m->nCaps = 0;
+    if (++gGen == 0) {              /* wrapped: forget all the states */
+        if (gStates) memset(gStates, 0, gStatesSize*sizeof(ruleState));
+        gGen = 1;
+    }
+    gNStates = 0;
+    gName = name;
+    if (gNNodes) match_node(0, name, 0, &cur, &bestId, m);
+    return bestId;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	rules_expand
+ *
+ * Description:	Substitute the captures of the match into the template
+ *
+ * Arg(s) In:	templ  -  Text with $0..$9 and $$
+ *              name   -  The matched name, for $0
+ *              m      -  The match
+ *
+ * Arg(s) Out:	out    -  Result, size bytes
+ *
+ * Return(s):	0 - success, 1 - result too long or $n without capture
+ *
+ **************************************************************************-*/
+
+int rules_expand (const char *templ, const char *name, const ruleMatch *m, char *out, size_t size)
+{
+    size_t len = 0, n;
+    const char *t, *src;
+
+    for (t = templ; *t; t++)
+    {
+        src = t;
+        n = 1;
+        if (*t == '$' && t[1] == '$') t++;
+        else if (*t == '$' && t[1] >= '0' && t[1] <= '9')
+        {
+            int ii = t[1] - '0';
+            if (ii > m->nCaps) return 1;
+            src = ii ? m->cap[ii-1] : name;
+            n = ii ? (size_t)m->capLen[ii-1] : strlen(name);
+            t++;
+        }
+        if (len + n >= size) return 1;
+        memcpy(out + len, src, n);
+        len += n;
+    }
+    out[len] = '\0';
+    return 0;
+}
+
+void rules_free (void)
+{
+    free(gNodes);
+    gNodes = NULL;
+    gNNodes = gNodesSize = 0;
+    free(gStates);
+    gStates = NULL;
+    gNStates = gStatesSize = 0;
+}
@@ -0,0 +1,39 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Pattern rules of the epics to ado map
+ *
+ * A map row whose PV column contains '*' (any characters, also none) or '?'
+ * (one character) is a rule. The text matched by the wildcards is captured
+ * and substituted for $1..$9 in the parameter, out= and ado= columns, $0 is
+ * the whole PV name, $$ a '$':
+ *   ,IOC:BPM*:X,>,bpm.$1:xM     IOC:BPM12:X -> bpm.12:xM
+ * The patterns are compiled into one prefix trie, the lookup of a name walks
+ * the trie along the name, so its cost depends on the name and the shared
+ * prefixes, not on the number of rules. A walk state after a '*' (trie
+ * node, position in the name) is explored once per lookup, so several
+ * stars in a pattern cost at most the trie nodes times the name length.
+ * Literal names can be added to the same trie. When several patterns
+ * match, the lowest id wins.
+ */
+
+#ifndef INCLrulesh
+#define INCLrulesh
+
+#define RULE_MAX_CAPTURES 9         /* $1..$9 */
+#define RULE_MAX_NODES 1000000      /* Max trie nodes */
+
+/* Text captured by the wildcards of the matching pattern */
+typedef struct ruleMatch
+{
+    int nCaps;
+    const char *cap[RULE_MAX_CAPTURES];
+    int capLen[RULE_MAX_CAPTURES];
+} ruleMatch;
+
+extern int  rules_add (const char *pattern, int id);
+extern int  rules_match (const char *name, ruleMatch *m);
+extern int  rules_expand (const char *templ, const char *name, const ruleMatch *m,
+                          char *out, size_t size);
+extern int  rules_is_pattern (const char *s);
+extern void rules_free (void);
+
+#endif /* ifndef INCLrulesh */
@@ -0,0 +1,169 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Publisher of the shared-memory latest-value table
+ *
+ * version v01 2026-10-19. Slots per channel, seqlock writes.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "pv_meta.h"
+#include "e2a_shm.h"
+#include "shm_pub.h"
+
+static e2aShmHeader *gHdr = NULL;
+static e2aShmSlot *gSlots = NULL;
+static size_t gSize = 0;
+static const pv *gPubPvs = NULL;    // slot n is channel gPubPvs[n]
+static const char *gName = NULL;
+
+// begin_write, end_write - the seqlock of the slot, the event loop is the only writer
+static void begin_write (e2aShmSlot *s)
+{
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void end_write (e2aShmSlot *s)
+{
+    __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+}
+
+/*+**************************************************************************
+ *
+ * Function:	shm_pub_open
+ *
+ * Description:	Create the table, replacing the one of a previous run
+ *
+ * Arg(s) In:	name  -  Shared-memory object, e.g. /epics2ado
+ *              pvs   -  Channels, names set
+ *              nPvs  -  Number of channels
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+int shm_pub_open (const char *name, const pv *pvs, int nPvs)
+{
+    int fd, ii;
+    void *p;
+
+    gSize = sizeof(e2aShmHeader) + (size_t)nPvs*sizeof(e2aShmSlot);
+    shm_unlink(name);                   /* readers of the old table see it closed */
+    fd = shm_open(name, O_RDWR|O_CREAT|O_EXCL, 0644);
+    if (fd < 0 || ftruncate(fd, gSize) < 0) {
+        perror(name);
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+    p = mmap(NULL, gSize, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror("mmap");
+        shm_unlink(name);
+        return 1;
+    }
+    gHdr = p;
+    gSlots = (e2aShmSlot *)(gHdr + 1);
+    gPubPvs = pvs;
+    gName = name;
+    for (ii = 0; ii < nPvs; ii++)
+    {
+        strncpy(gSlots[ii].name, pvs[ii].name, E2A_SHM_NAME_SIZE-1);
+        gSlots[ii].v.dbrType = -1;
+    }
+    gHdr->nSlots = nPvs;
+    gHdr->slotSize = sizeof(e2aShmSlot);
+    gHdr->pid = getpid();
+    gHdr->version = E2A_SHM_VERSION;
+    __atomic_store_n(&gHdr->magic, E2A_SHM_MAGIC, __ATOMIC_RELEASE);
+    if (gVerb&VERB_INFO) printf("Latest values of %i channels published in %s\n", nPvs, name);
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	shm_pub_update
+ *
+ * Description:	Publish the monitor update of the channel
+ *
+ * Arg(s) In:	ppv    -  Channel
+ *              type   -  DBR_TIME_* type
+ *              count  -  Number of elements
+ *              dbr    -  Value
+ *
+ **************************************************************************-*/
+
+void shm_pub_update (pv *ppv, long type, unsigned long count, const void *dbr)
+{
+    const struct dbr_time_double *h = dbr;
+    e2aShmSlot *s;
+    unsigned long n = count < E2A_SHM_MAX_ELEMS ? count : E2A_SHM_MAX_ELEMS, ii;
+    void *value = ppv->value;
+    long dbrType = ppv->dbrType;
+    int strType = type;
+    const char *str = "";
+    const void *val;
+
+    if (!gHdr) return;
+    s = &gSlots[ppv - gPubPvs];
+    if (type == DBR_TIME_STRING || type == DBR_TIME_ENUM)
+    {                                   /* numbers are not formatted, readers have the doubles */
+        ppv->value = (void *)dbr;       /* for the enum strings of the metadata */
+        ppv->dbrType = type;
+        str = meta_val2str(ppv, 0, &strType);
+        ppv->value = value;
+        ppv->dbrType = dbrType;
+    }
+
+    begin_write(s);
+    s->v.dbrType = type;
+    s->v.status = h->status;
+    s->v.severity = h->severity;
+    s->v.secPastEpoch = h->stamp.secPastEpoch;
+    s->v.nsec = h->stamp.nsec;
+    s->v.count = count;
+    s->v.updates++;
+    strncpy(s->v.str, str, E2A_SHM_STRING_SIZE-1);
+    val = dbr_value_ptr(dbr, type);
+#define SHM_CONVERT(T) { const T *src = val; for (ii = 0; ii < n; ii++) s->v.value[ii] = src[ii]; }
+    switch (type) {
+    case DBR_TIME_SHORT:  SHM_CONVERT(dbr_short_t); break;
+    case DBR_TIME_FLOAT:  SHM_CONVERT(dbr_float_t); break;
+    case DBR_TIME_ENUM:   SHM_CONVERT(dbr_enum_t); break;
+    case DBR_TIME_CHAR:   SHM_CONVERT(dbr_char_t); break;
+    case DBR_TIME_LONG:   SHM_CONVERT(dbr_long_t); break;
+    case DBR_TIME_DOUBLE: SHM_CONVERT(dbr_double_t); break;
+    default: n = 0;
+    }
+#undef SHM_CONVERT
+    s->v.nValues = n;
+    end_write(s);
+}
+
+void shm_pub_connection (const pv *ppv, int connected)
+{
+    e2aShmSlot *s;
+
+    if (!gHdr) return;
+    s = &gSlots[ppv - gPubPvs];
+    begin_write(s);
+    s->v.connected = connected;
+    end_write(s);
+}
+
+void shm_pub_close (void)
+{
+    if (!gHdr) return;
+    __atomic_store_n(&gHdr->closed, 1, __ATOMIC_RELEASE);
+    munmap(gHdr, gSize);
+    shm_unlink(gName);
+    gHdr = NULL;
+}
@@ -0,0 +1,18 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Publisher of the shared-memory latest-value table (-P option)
+ *
+ * Writer side of e2a_shm.h: the table is created at startup with one slot
+ * per channel, in channel order, and updated from the event loop with every
+ * monitor update as it arrives (before reduction and queueing) and with
+ * every connection change. The table is removed at exit.
+ */
+
+#ifndef INCLshm_pubh
+#define INCLshm_pubh
+
+extern int  shm_pub_open (const char *name, const pv *pvs, int nPvs);
+extern void shm_pub_update (pv *ppv, long type, unsigned long count, const void *dbr);
+extern void shm_pub_connection (const pv *ppv, int connected);
+extern void shm_pub_close (void);
+
+#endif /* ifndef INCLshm_pubh */
@@ -0,0 +1,329 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Soak test mode of the epics to ado bridge (-K option)
+ *
+ * version v01 2026-10-19. Synthetic or replayed source, mock ADO sink,
+ *                         RSS/heap/fd growth check.
+ * version v02 2026-10-19. Mock sink takes batches.
+ * version v03 2026-10-19. Typed items, mock discovery.
+ * version v04 2026-10-19. Mock sink also for the group setter.
+ * version v05 2026-10-19. Replayed records checked, bad and unmatched ones skipped.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <malloc.h>
+
+#include <epicsTime.h>
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "reactor.h"
+#include "mon_out.h"
+#include "pv_meta.h"
+#include "ado_batch.h"
+#include "ado_group.h"
+#include "soak.h"
+
+double gSoakDuration = 0.;
+unsigned long gSoakAllowance = SOAK_ALLOWANCE;
+char *gSoakReplay = NULL;
+
+/* One prepared event of the source */
+typedef struct soakEvent
+{
+    pv   *ppv;
+    long  dbrType;
+    unsigned long count;
+    void *dbr;
+} soakEvent;
+
+/* Resource usage sample */
+typedef struct soakSample
+{
+    unsigned long rssKB;
+    unsigned long heapKB;
+    int fds;
+} soakSample;
+
+static soakEvent *gEvents = NULL;
+static int gNEvents = 0;
+static int gNext = 0;
+static unsigned long gGenerated = 0;
+static unsigned long gSunk = 0;
+static unsigned long gSunkBytes = 0;
+static soakEventFunc *gSoakEvent = NULL;
+static int (*gSoakWork)(void) = NULL;
+static double gStart = 0.;
+static int gHaveBaseline = 0;
+static soakSample gBaseline, gLast;
+
+// soak_ado_set - mock ADO sink, same signature as adoSetBatch and adoSetGroup
+int soak_ado_set (const char* adoName, const int n, const adoItem items[])
+{
+    int ii;
+    for (ii = 0; ii < n; ii++)
+        gSunkBytes += items[ii].count > 1 ? items[ii].count*sizeof(double)
+                    : items[ii].type == adoTypeString ? strlen(items[ii].str) : sizeof(double);
+    gSunk += n;
+    return 0;
+}
+
+// soak_ado_discover - mock discovery, the type is guessed from the DBR type
+int soak_ado_discover (const char* adoName, const char* paramName, unsigned long *length)
+{
+    *length = 1;
+    return adoTypeGuess;
+}
+
+static void soak_sample (soakSample *s)
+{
+    FILE *f = fopen("/proc/self/statm", "r");
+    unsigned long size = 0, resident = 0;
+    DIR *d;
+    struct dirent *de;
+
+    if (f) {
+        if (fscanf(f, "%lu %lu", &size, &resident) != 2) resident = 0;
+        fclose(f);
+    }
+    s->rssKB = resident * (sysconf(_SC_PAGESIZE) / 1024);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    s->heapKB = mallinfo2().uordblks / 1024;
+#else
+    s->heapKB = (unsigned) mallinfo().uordblks / 1024;
+#endif
+    s->fds = 0;
+    d = opendir("/proc/self/fd");
+    if (d) {
+        while ((de = readdir(d)) != NULL)
+            if (de->d_name[0] != '.') s->fds++;
+        closedir(d);
+        s->fds--;                       /* the fd of the directory itself */
+    }
+}
+
+static void sample_timer (void *arg, int fd)
+{
+    double t = sched_now() - gStart;
+    soak_sample(&gLast);
+    if (!gHaveBaseline && t >= SOAK_WARMUP_FRACTION*gSoakDuration) {
+        gBaseline = gLast;
+        gHaveBaseline = 1;
+    }
+    if (gVerb&VERB_INFO)
+        printf("soak %7.1f s: events %lu, written %lu, rss %lu kB, heap %lu kB, queues %lu B, fds %i\n",
+               t, gGenerated, gSunk, gLast.rssKB, gLast.heapKB, gSchedBytes, gLast.fds);
+}
+
+static void stop_timer (void *arg, int fd)
+{
+    reactor_stop();
+}
+
+/* Synthetic events: scalar double, enum, long array and string channels */
+static int soak_synthetic (pv *pvs, int nPvs)
+{
+    static const long types[] = {DBR_TIME_DOUBLE, DBR_TIME_ENUM, DBR_TIME_LONG, DBR_TIME_STRING};
+    int n;
+
+    gEvents = calloc(nPvs, sizeof(soakEvent));
+    if (!gEvents) return 1;
+    for (n = 0; n < nPvs; n++)
+    {
+        soakEvent *ev = &gEvents[n];
+        ev->ppv = &pvs[n];
+        ev->dbrType = types[n % 4];
+        ev->count = ev->dbrType == DBR_TIME_LONG ? SOAK_ARRAY_ELEMS : 1;
+        ev->dbr = calloc(1, dbr_size_n(ev->dbrType, ev->count));
+        if (!ev->dbr) return 1;
+        pvs[n].dbfType = ev->dbrType - DBR_TIME_STRING;
+        pvs[n].onceConnected = 1;
+        if (ev->dbrType == DBR_TIME_ENUM) {
+            struct pvMeta *m = calloc(1, sizeof(struct pvMeta));
+            if (!m) return 1;
+            m->noStr = 4;
+            strcpy(m->strs[0], "Off"); strcpy(m->strs[1], "On");
+            strcpy(m->strs[2], "Fault"); strcpy(m->strs[3], "Unknown");
+            pvs[n].meta = m;
+        }
+    }
+    gNEvents = nPvs;
+    return 0;
+}
+
+/* Events recorded with -o bin, replayed cyclically */
+static int soak_load_replay (pv *pvs, int nPvs, const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    int *pvOfIndex = NULL;              // index -> pv, -1: no name record matched
+    int nIndex = 0, nAlloc = 0;
+    unsigned long skipped = 0;
+    monRecord rec;
+
+    if (!f) {
+        perror(filename);
+        return 1;
+    }
+    while (fread(&rec, sizeof(rec), 1, f) == 1)
+    {
+        size_t payload = rec.length - sizeof(rec);
+        char *buf;
+        if (rec.magic != MON_RECORD_MAGIC || rec.length < sizeof(rec) || rec.length > SOAK_MAX_RECORD) {
+            fprintf(stderr, "%s: not a -o bin recording\n", filename);
+            fclose(f);
+            free(pvOfIndex);
+            return 1;
+        }
+        buf = malloc(payload + 1);
+        if (!buf || fread(buf, 1, payload, f) != payload) {
+            free(buf);
+            break;
+        }
+        if (rec.pvIndex >= SOAK_MAX_INDEX
+            || (rec.dbrType != MON_RECORD_NAME && (!dbr_type_is_TIME(rec.dbrType) || rec.count == 0
+                || rec.count > payload/dbr_value_size[rec.dbrType]))) {
+            skipped++;                  /* bad index, type or size */
+            free(buf);
+            continue;
+        }
+        if ((int)rec.pvIndex >= nIndex) {     /* grow the index -> pv table */
+            int n = rec.pvIndex + 1;
+            int *p = realloc(pvOfIndex, n*sizeof(int));
+            if (!p) { free(buf); break; }
+            for (; nIndex < n; nIndex++) p[nIndex] = -1;
+            pvOfIndex = p;
+        }
+        if (rec.dbrType == MON_RECORD_NAME) {  /* match the recorded name to the map */
+            int n;
+            buf[payload] = '\0';
+            for (n = 0; n < nPvs; n++)
+                if (strcmp(pvs[n].name, buf) == 0) pvOfIndex[rec.pvIndex] = n;
+            free(buf);
+            continue;
+        }
+        if (pvOfIndex[rec.pvIndex] < 0) {
+            skipped++;                  /* PV not in the map */
+            free(buf);
+            continue;
+        }
+        if (gNEvents >= nAlloc) {
+            soakEvent *p;
+            nAlloc = nAlloc ? 2*nAlloc : 1024;
+            p = realloc(gEvents, nAlloc*sizeof(soakEvent));
+            if (!p) { free(buf); break; }
+            gEvents = p;
+        }
+        {
+            soakEvent *ev = &gEvents[gNEvents];
+            struct dbr_time_double *hdr;
+            ev->ppv = &pvs[pvOfIndex[rec.pvIndex]];
+            ev->dbrType = rec.dbrType;
+            ev->count = rec.count;
+            ev->dbr = calloc(1, dbr_size_n(rec.dbrType, rec.count));
+            if (!ev->dbr) { free(buf); break; }
+            hdr = ev->dbr;
+            hdr->status = rec.status;
+            hdr->severity = rec.severity;
+            memcpy(dbr_value_ptr(ev->dbr, rec.dbrType), buf, rec.count*dbr_value_size[rec.dbrType]);
+            ev->ppv->onceConnected = 1;
+            gNEvents++;
+        }
+        free(buf);
+    }
+    fclose(f);
+    free(pvOfIndex);
+    if (gVerb&VERB_INFO) printf("Replaying %i events from %s\n", gNEvents, filename);
+    if (skipped) printf("%s: %lu records skipped: bad type, size or index, or PV not in the map\n", filename, skipped);
+    return gNEvents == 0;
+}
+
+/* Produce the next event: new timestamp, for synthetic channels a new value */
+static void soak_feed_one (void)
+{
+    soakEvent *ev = &gEvents[gNext];
+    struct dbr_time_double *hdr = ev->dbr;
+    void *val = dbr_value_ptr(ev->dbr, ev->dbrType);
+    unsigned long ii;
+
+    epicsTimeGetCurrent(&hdr->stamp);
+    if (!gSoakReplay) switch (ev->dbrType) {
+    case DBR_TIME_DOUBLE: *(dbr_double_t *)val = gGenerated*0.001; break;
+    case DBR_TIME_ENUM:   *(dbr_enum_t *)val = gGenerated % 4; break;
+    case DBR_TIME_LONG:
+        for (ii = 0; ii < ev->count; ii++) ((dbr_long_t *)val)[ii] = gGenerated + ii;
+        break;
+    case DBR_TIME_STRING: sprintf(val, "soak %lu", gGenerated); break;
+    }
+    gSoakEvent(ev->ppv, ev->dbrType, ev->count, ev->dbr);
+    gGenerated++;
+    if (++gNext >= gNEvents) gNext = 0;
+}
+
+static int soak_work (void)
+{
+    int ii;
+    for (ii = 0; ii < SOAK_BATCH; ii++) soak_feed_one();
+    gSoakWork();
+    return 1;                           /* never block, run at maximum rate */
+}
+
+/*+**************************************************************************
+ *
+ * Function:	soak_run
+ *
+ * Description:	Run the soak test for gSoakDuration seconds
+ *
+ * Arg(s) In:	pvs    -  Pointer to an array of pv structures (not connected)
+ *              nPvs   -  Number of elements in the pvs array
+ *              event  -  Event path of the bridge, called for each event
+ *              work   -  Loop work of the bridge (queue draining, output)
+ *
+ * Return(s):	0 - passed, 1 - failed or could not run
+ *
+ **************************************************************************-*/
+
+int soak_run (pv *pvs, int nPvs, soakEventFunc *event, int (*work)(void))
+{
+    long rssGrowth, heapGrowth;
+    int failed;
+    double elapsed;
+
+    gSoakEvent = event;
+    gSoakWork = work;
+    if (gSoakReplay ? soak_load_replay(pvs, nPvs, gSoakReplay) : soak_synthetic(pvs, nPvs)) {
+        fprintf(stderr, "Failed to prepare the soak test source.\n");
+        return 1;
+    }
+    printf("Soak test for %g s, allowed growth %lu kB\n", gSoakDuration, gSoakAllowance);
+    gStart = sched_now();
+    if (reactor_add_timer(SOAK_SAMPLE_PERIOD, SOAK_SAMPLE_PERIOD, sample_timer, NULL) < 0 ||
+        reactor_add_timer(gSoakDuration, 0., stop_timer, NULL) < 0)
+        return 1;
+    reactor_run(soak_work);
+    elapsed = sched_now() - gStart;
+
+    soak_sample(&gLast);
+    if (!gHaveBaseline) {
+        fprintf(stderr, "Soak test too short for a baseline sample.\n");
+        return 1;
+    }
+    rssGrowth = (long)gLast.rssKB - (long)gBaseline.rssKB;
+    heapGrowth = (long)gLast.heapKB - (long)gBaseline.heapKB;
+    failed = rssGrowth > (long)gSoakAllowance || heapGrowth > (long)gSoakAllowance
+             || gLast.fds > gBaseline.fds;
+    printf("Soak test %s: %lu events in %.1f s (%.0f/s), %lu ADO writes (%lu bytes)\n"
+           "  rss %lu -> %lu kB (%+ld), heap %lu -> %lu kB (%+ld), fds %i -> %i\n",
+           failed ? "FAILED" : "passed", gGenerated, elapsed, gGenerated/elapsed,
+           gSunk, gSunkBytes,
+           gBaseline.rssKB, gLast.rssKB, rssGrowth,
+           gBaseline.heapKB, gLast.heapKB, heapGrowth,
+           gBaseline.fds, gLast.fds);
+    sched_report(stdout);
+    batch_report(stdout);
+    group_report(stdout);
+    return failed;
+}
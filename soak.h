@@ -0,0 +1,36 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Soak test mode of the epics to ado bridge (-K option)
+ *
+ * The channels of the map are fed at maximum rate from a synthetic source,
+ * or from a file recorded with -o bin, through the normal queueing and
+ * conversion path into a mock ADO sink. RSS, heap usage and open file
+ * descriptors are sampled periodically; the test fails if they grow after
+ * the warm-up by more than the allowance. The records of a replayed file
+ * are checked: those of an unknown DBR type, of a PV index without a name
+ * record matching the map, or whose values do not fit the record are
+ * skipped and counted.
+ */
+
+#ifndef INCLsoakh
+#define INCLsoakh
+
+#define SOAK_SAMPLE_PERIOD 1.       /* Resource sampling period, s */
+#define SOAK_WARMUP_FRACTION 0.2    /* Part of the run before the baseline sample */
+#define SOAK_BATCH 1000             /* Synthetic events per loop iteration */
+#define SOAK_ARRAY_ELEMS 100        /* Length of the synthetic arrays */
+#define SOAK_ALLOWANCE 512          /* Default allowed growth, kB */
+#define SOAK_MAX_INDEX 1000000      /* Max PV index of a replayed record */
+#define SOAK_MAX_RECORD (64 << 20)  /* Max length of a replayed record, bytes */
+
+/* Called for each generated event, as the CA event handler would */
+typedef void soakEventFunc (pv *ppv, long dbrType, unsigned long count, const void *dbr);
+
+extern double gSoakDuration;        /* Duration of the soak test, s (-K option) */
+extern unsigned long gSoakAllowance; /* Allowed growth of RSS and heap, kB */
+extern char *gSoakReplay;           /* File recorded with -o bin, NULL: synthetic */
+
+extern int soak_ado_set (const char* adoName, const int n, const adoItem items[]);
+extern int soak_ado_discover (const char* adoName, const char* paramName, unsigned long *length);
+extern int soak_run (pv *pvs, int nPvs, soakEventFunc *event, int (*work)(void));
+
+#endif /* ifndef INCLsoakh */
@@ -0,0 +1,771 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Supervisor mode of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Map partitioned by ADO or IOC, forked workers restarted after crashes, counters aggregated.
+ * version v02 2026-10-19. Workers also restarted after a non-zero exit.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+
+#include <cadef.h>
+
+#include "tool_lib.h"
+#include "epics2ado.h"
+#include "ado_sched.h"
+#include "ado_group.h"
+#include "pva_in.h"
+#include "reactor.h"
+#include "super.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME  1099511628211ULL
+
+#define KEY_ADO 0                   /* Partition by the ADO of the record */
+#define KEY_IOC 1                   /* Partition by the PV name up to the first ':' */
+
+#define NAME_PV 0                   /* Kinds of the names in the partition table */
+#define NAME_KEY 1
+
+/* Counters of a worker, sent over its pipe, smaller than PIPE_BUF */
+typedef struct superStats
+{
+    double uptime;                  // s
+    unsigned long channels;
+    unsigned long connected;
+    unsigned long events;           // updates received
+    unsigned long written;          // updates handed to the ADO writer
+    unsigned long dropped;          // updates lost on overflow
+    unsigned long queued;           // updates waiting now
+} superStats;
+
+/* One shard run on this host */
+typedef struct superWorker
+{
+    int    shard;
+    pid_t  pid;                     // 0: not running
+    int    fd;                      // read end of the counters pipe, -1: none
+    double started;                 // sched_now() of the last start
+    double restartAt;               // sched_now() of the pending restart, 0: none
+    double delay;                   // delay of the next restart, s
+    int    restarts;
+    int    exited;                  // 1: exited, not restarted
+    int    status;                  // exit status, 128 + signal if killed
+    superStats st;                  // last counters received
+} superWorker;
+
+/* Open addressing table of names, pointers into the map or the partition file */
+typedef struct superName
+{
+    const char *s;                  // NULL: free entry
+    size_t len;
+    int    kind;
+    int    val;                     // first record of the name, or its shard
+} superName;
+
+typedef struct nameTable
+{
+    superName *e;
+    size_t size;                    // power of 2
+} nameTable;
+
+int gSuperShards = 0;
+static int gFirst = 0, gLast = -1;  // shards of this host
+static int gKey = KEY_ADO;
+static superWorker gWorkers[SUPER_MAX_SHARDS];
+static int gNWorkers = 0;
+static int gSigFd = -1;
+static sigset_t gOldMask;
+static int gStatsFd = -1;           // worker: write end of the counters pipe
+static double gWorkerStart = 0.;
+static pv *gWorkerPvs = NULL;
+static int gWorkerNPvs = 0;
+
+/*+**************************************************************************
+ *
+ * Function:	super_parse
+ *
+ * Description:	Parse the -j option
+ *
+ * Arg(s) In:	spec  -  <n>[:<first>[-<last>]][,ado|ioc]
+ *
+ * Return(s):	0 - success, 1 - invalid specification
+ *
+ **************************************************************************-*/
+
+int super_parse (const char *spec)
+{
+    int n, first, last, len = 0;
+    const char *p;
+
+    if (sscanf(spec, "%d%n", &n, &len) != 1 || n < 1 || n > SUPER_MAX_SHARDS) return 1;
+    p = spec + len;
+    first = 0;
+    last = n - 1;
+    if (*p == ':')
+    {
+        if (sscanf(p + 1, "%d%n", &first, &len) != 1) return 1;
+        p += 1 + len;
+        last = first;
+        if (*p == '-') {
+            if (sscanf(p + 1, "%d%n", &last, &len) != 1) return 1;
+            p += 1 + len;
+        }
+    }
+    if (first < 0 || last < first || last >= n) return 1;
+    if (*p == ',') {
+        if (strcmp(p + 1, "ado") == 0)      gKey = KEY_ADO;
+        else if (strcmp(p + 1, "ioc") == 0) gKey = KEY_IOC;
+        else return 1;
+    }
+    else if (*p) return 1;
+    gSuperShards = n;
+    gFirst = first;
+    gLast = last;
+    return 0;
+}
+
+char *super_path (const char *path, int shard)
+{
+    char *p;
+    if (!path) return NULL;
+    p = malloc(strlen(path) + 16);
+    if (p) sprintf(p, "%s.%i", path, shard);
+    return p;
+}
+
+//''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Partitioning
+
+static uint64_t name_hash (const char *s, size_t len, int kind)
+{
+    uint64_t h = FNV_OFFSET ^ (uint64_t)kind;
+    size_t ii;
+    for (ii = 0; ii < len; ii++)
+    {
+        h ^= (unsigned char)s[ii];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+static int table_init (nameTable *t, size_t nNames)
+{
+    for (t->size = 16; t->size < 2*nNames; t->size *= 2) ;
+    t->e = calloc(t->size, sizeof(superName));
+    return t->e == NULL;
+}
+
+/* Value of the name; if it is missing and add is set, it is added with val */
+static int table_lookup (nameTable *t, const char *s, size_t len, int kind, int val, int add)
+{
+    size_t ii = name_hash(s, len, kind) & (t->size - 1);
+    for (;; ii = (ii + 1) & (t->size - 1))
+    {
+        superName *e = &t->e[ii];
+        if (!e->s) {
+            if (!add) return -1;
+            e->s = s;
+            e->len = len;
+            e->kind = kind;
+            e->val = val;
+            return val;
+        }
+        if (e->kind == kind && e->len == len && memcmp(e->s, s, len) == 0) return e->val;
+    }
+}
+
+static const char *key_of (const mapRec *rec, const char *adoName, size_t *len)
+{
+    if (gKey == KEY_IOC) {
+        *len = strcspn(rec->pvName, ":");
+        return rec->pvName;
+    }
+    *len = strlen(rec->ado ? rec->ado : adoName);
+    return rec->ado ? rec->ado : adoName;
+}
+
+static int find_root (int parent[], int ii)
+{
+    while (parent[ii] != ii) ii = parent[ii] = parent[parent[ii]];
+    return ii;
+}
+
+/* Join the sets of the records, the lowest record is the root */
+static void unite (int parent[], int a, int b)
+{
+    a = find_root(parent, a);
+    b = find_root(parent, b);
+    if (a < b)      parent[b] = a;
+    else if (b < a) parent[a] = b;
+}
+
+/* Whole file, NULL with errno set if it cannot be read */
+static char *read_file (const char *path, size_t *nLines)
+{
+    FILE *f = fopen(path, "r");
+    char *buf = NULL;
+    long size;
+    size_t ii;
+
+    if (!f) return NULL;
+    if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0
+        && (buf = malloc(size + 1)) != NULL)
+    {
+        if (fread(buf, 1, size, f) != (size_t)size) {
+            free(buf);
+            buf = NULL;
+        }
+        else buf[size] = '\0';
+    }
+    fclose(f);
+    if (!buf) return NULL;
+    for (*nLines = 1, ii = 0; buf[ii]; ii++) *nLines += buf[ii] == '\n';
+    return buf;
+}
+
+/* Shards of the sets of records from the partition file */
+static int assign_from_file (const char *path, char *file, size_t nLines, const mapRec recs[],
+                             int nrecs, const char *adoName, int parent[], int shard[])
+{
+    nameTable t;
+    char *line, *next, *key;
+    int ii, s, lineNo = 0;
+
+    if (table_init(&t, nLines)) return 1;
+    for (line = file; line; line = next)
+    {
+        next = strchr(line, '\n');
+        if (next) *next++ = '\0';
+        lineNo++;
+        key = line + strspn(line, " \t");
+        if (*key == '\0' || *key == '#') continue;
+        line = key + strcspn(key, " \t");
+        if (*line) *line++ = '\0';
+        if (sscanf(line, "%d", &s) != 1 || s < 0 || s >= gSuperShards) {
+            fprintf(stderr, "%s:%i: shard of %s missing or not below %i\n", path, lineNo, key, gSuperShards);
+            free(t.e);
+            return 1;
+        }
+        table_lookup(&t, key, strlen(key), 0, s, 1);
+    }
+    for (ii = 0; ii < nrecs; ii++)      // a set goes where its first listed key is
+    {
+        int root = find_root(parent, ii);
+        size_t len;
+        const char *k = key_of(&recs[ii], adoName, &len);
+        if (shard[root] < 0) shard[root] = table_lookup(&t, k, len, 0, -1, 0);
+    }
+    for (ii = 0; ii < nrecs; ii++)
+    {
+        int root = find_root(parent, ii);
+        size_t len;
+        const char *k = key_of(&recs[root], adoName, &len);
+        if (shard[root] < 0) shard[root] = name_hash(k, len, 0) % gSuperShards;
+    }
+    free(t.e);
+    return 0;
+}
+
+/* Set of records to place, sorted by decreasing size */
+typedef struct superSet
+{
+    int weight;                     // number of records
+    int root;
+} superSet;
+
+static int set_cmp (const void *a, const void *b)
+{
+    const superSet *x = a, *y = b;
+    if (x->weight != y->weight) return y->weight - x->weight;
+    return x->root - y->root;
+}
+
+/* Shards of the sets of records: the largest set onto the least loaded shard */
+static int assign_balanced (int nrecs, int parent[], int shard[])
+{
+    superSet *sets = calloc(nrecs, sizeof(superSet));
+    int *weight = calloc(nrecs, sizeof(int));
+    unsigned long load[SUPER_MAX_SHARDS];
+    int ii, s, best, nSets = 0;
+
+    if (!sets || !weight) {
+        free(sets);
+        free(weight);
+        return 1;
+    }
+    for (ii = 0; ii < nrecs; ii++) weight[find_root(parent, ii)]++;
+    for (ii = 0; ii < nrecs; ii++)
+        if (weight[ii]) {
+            sets[nSets].root = ii;
+            sets[nSets++].weight = weight[ii];
+        }
+    free(weight);
+    qsort(sets, nSets, sizeof(superSet), set_cmp);
+    memset(load, 0, sizeof(load));
+    for (ii = 0; ii < nSets; ii++)
+    {
+        for (best = 0, s = 1; s < gSuperShards; s++)
+            if (load[s] < load[best]) best = s;
+        shard[sets[ii].root] = best;
+        load[best] += sets[ii].weight;
+    }
+    free(sets);
+    return 0;
+}
+
+/* Write the partition as a new file, 2: created meanwhile by another host */
+static int write_partition (const char *path, const mapRec recs[], int nrecs, const char *adoName,
+                            nameTable *t, int parent[], int shard[])
+{
+    char *tmp = malloc(strlen(path) + 32);
+    FILE *f;
+    int ii, failed;
+
+    if (!tmp) return 1;
+    sprintf(tmp, "%s.%i.tmp", path, (int)getpid());
+    if (!(f = fopen(tmp, "w"))) {
+        perror(tmp);
+        free(tmp);
+        return 1;
+    }
+    fprintf(f, "# epics2ado partition into %i shards by %s: <key> <shard>\n",
+            gSuperShards, gKey == KEY_IOC ? "ioc" : "ado");
+    for (ii = 0; ii < nrecs; ii++)
+    {
+        size_t len;
+        const char *k = key_of(&recs[ii], adoName, &len);
+        if (table_lookup(t, k, len, NAME_KEY, ii, 0) == ii)     // first record of the key
+            fprintf(f, "%.*s %i\n", (int)len, k, shard[find_root(parent, ii)]);
+    }
+    failed = fclose(f) != 0;
+    if (!failed && link(tmp, path) < 0)
+    {
+        failed = errno == EEXIST ? 2 : 1;
+        if (failed == 1) perror(path);
+    }
+    unlink(tmp);
+    free(tmp);
+    return failed;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	partition
+ *
+ * Description:	Assign the map records to the shards
+ *
+ * Arg(s) In:	recs      -  Map records
+ *              nrecs     -  Number of records
+ *              adoName   -  ADO of the records without ado=
+ *              partPath  -  Partition file, NULL: none
+ *
+ * Arg(s) Out:	shardOf   -  Shard of each record
+ *
+ * Return(s):	0 - success, 1 - failure
+ *
+ **************************************************************************-*/
+
+static int partition (const mapRec recs[], int nrecs, const char *adoName, const char *partPath,
+                      int shardOf[])
+{
+    int *parent = malloc(nrecs*sizeof(int));
+    int *shard = malloc(nrecs*sizeof(int));
+    int grpFirst[GROUP_MAX+1];
+    char *file = NULL;
+    size_t nLines = 0;
+    nameTable t = {NULL, 0};
+    int ii, failed = 0;
+
+    if (!parent || !shard || table_init(&t, 2*(size_t)nrecs))
+    {
+        fprintf(stderr, "Memory allocation for the partition failed.\n");
+        free(parent);
+        free(shard);
+        free(t.e);
+        return 1;
+    }
+    for (ii = 0; ii <= GROUP_MAX; ii++) grpFirst[ii] = -1;
+    for (ii = 0; ii < nrecs; ii++)
+    {
+        size_t len;
+        const char *k = key_of(&recs[ii], adoName, &len);
+        parent[ii] = ii;
+        shard[ii] = -1;
+        unite(parent, ii, table_lookup(&t, recs[ii].pvName, strlen(recs[ii].pvName), NAME_PV, ii, 1));
+        unite(parent, ii, table_lookup(&t, k, len, NAME_KEY, ii, 1));
+        if (recs[ii].grp)
+        {
+            if (grpFirst[recs[ii].grp] < 0) grpFirst[recs[ii].grp] = ii;
+            unite(parent, ii, grpFirst[recs[ii].grp]);
+        }
+    }
+    if (partPath && !(file = read_file(partPath, &nLines)) && errno != ENOENT)
+    {
+        perror(partPath);
+        failed = 1;
+    }
+    if (!failed && !file)
+    {
+        failed = assign_balanced(nrecs, parent, shard);
+        if (!failed && partPath)
+        {
+            failed = write_partition(partPath, recs, nrecs, adoName, &t, parent, shard);
+            if (failed == 2 && (file = read_file(partPath, &nLines)) != NULL) {
+                for (ii = 0; ii < nrecs; ii++) shard[ii] = -1;
+                failed = 0;
+            }
+            else if (!failed) printf("Partition written to %s\n", partPath);
+        }
+    }
+    if (!failed && file) {
+        failed = assign_from_file(partPath, file, nLines, recs, nrecs, adoName, parent, shard);
+        if (!failed) printf("Partition read from %s\n", partPath);
+    }
+    for (ii = 0; ii < nrecs; ii++) shardOf[ii] = shard[find_root(parent, ii)];
+    free(file);
+    free(t.e);
+    free(parent);
+    free(shard);
+    return failed != 0;
+}
+
+//''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Supervisor
+
+static void super_report (FILE *out)
+{
+    superStats tot;
+    int ii, running = 0;
+
+    memset(&tot, 0, sizeof(tot));
+    for (ii = 0; ii < gNWorkers; ii++)
+    {
+        const superWorker *w = &gWorkers[ii];
+        fprintf(out, "  shard %i: ", w->shard);
+        if (w->pid)                fprintf(out, "pid %i, up %.1f s", (int)w->pid, w->st.uptime);
+        else if (w->restartAt > 0.) fprintf(out, "restart in %.1f s", w->restartAt - sched_now());
+        else                       fprintf(out, "exited (%i)", w->status);
+        fprintf(out, ", restarts %i, channels %lu, connected %lu, events %lu, written %lu,"
+                " dropped %lu, queued %lu\n", w->restarts, w->st.channels, w->st.connected,
+                w->st.events, w->st.written, w->st.dropped, w->st.queued);
+        running += w->pid != 0;
+        tot.channels += w->st.channels;
+        tot.connected += w->st.connected;
+        tot.events += w->st.events;
+        tot.written += w->st.written;
+        tot.dropped += w->st.dropped;
+        tot.queued += w->st.queued;
+    }
+    fprintf(out, "Supervisor: shards %i-%i of %i, running %i, channels %lu, connected %lu,"
+            " events %lu, written %lu, dropped %lu, queued %lu\n", gFirst, gLast, gSuperShards,
+            running, tot.channels, tot.connected, tot.events, tot.written, tot.dropped, tot.queued);
+}
+
+/* Take the counters sent by the worker, close the pipe at its end */
+static void read_stats (superWorker *w)
+{
+    superStats st;
+    ssize_t len;
+
+    while ((len = read(w->fd, &st, sizeof(st))) == sizeof(st)) w->st = st;
+    if (len == 0 || (len < 0 && errno != EAGAIN && errno != EINTR)) {
+        close(w->fd);
+        w->fd = -1;
+    }
+}
+
+/* Fork the worker of the shard: 0 in the worker, its pid in the supervisor, -1: failed */
+static pid_t spawn (superWorker *w)
+{
+    pid_t pid, super = getpid();
+    int fds[2], ii;
+
+    if (pipe(fds) < 0) {
+        perror("pipe");
+        return -1;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0)
+    {
+        close(fds[0]);
+        for (ii = 0; ii < gNWorkers; ii++)
+            if (gWorkers[ii].fd >= 0) close(gWorkers[ii].fd);
+        close(gSigFd);
+        gNWorkers = 0;
+        sigprocmask(SIG_SETMASK, &gOldMask, NULL);
+        prctl(PR_SET_PDEATHSIG, SIGTERM);       // do not outlive the supervisor
+        if (getppid() != super) _exit(1);
+        fcntl(fds[1], F_SETFL, O_NONBLOCK);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        gStatsFd = fds[1];
+        gWorkerStart = sched_now();
+        return 0;
+    }
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    w->pid = pid;
+    w->fd = fds[0];
+    w->started = sched_now();
+    w->restartAt = 0.;
+    memset(&w->st, 0, sizeof(w->st));
+    printf("Shard %i: worker %i started\n", w->shard, (int)pid);
+    return pid;
+}
+
+/* Keep the records of the shard */
+static int become_worker (mapRec recs[], int *nrecs, int shardOf[], int shard)
+{
+    int ii, n = 0;
+    for (ii = 0; ii < *nrecs; ii++)
+        if (shardOf[ii] == shard) {
+            if (n != ii) recs[n] = recs[ii];
+            n++;
+        }
+    *nrecs = n;
+    free(shardOf);
+    return shard;
+}
+
+/* Collect the exited workers, schedule the restarts of the failed ones */
+static void reap (int stopping)
+{
+    double now = sched_now();
+    pid_t pid;
+    int status, ii;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        superWorker *w = NULL;
+        for (ii = 0; ii < gNWorkers; ii++)
+            if (gWorkers[ii].pid == pid) w = &gWorkers[ii];
+        if (!w) continue;
+        w->pid = 0;
+        if (w->fd >= 0) read_stats(w);
+        if (w->fd >= 0) {
+            close(w->fd);
+            w->fd = -1;
+        }
+        if (!stopping && (WIFSIGNALED(status) || (WIFEXITED(status) && WEXITSTATUS(status) != 0)))
+        {
+            if (now - w->started >= SUPER_STABLE) w->delay = SUPER_RESTART_MIN;
+            w->restartAt = now + w->delay;
+            w->restarts++;
+            if (WIFSIGNALED(status))
+                fprintf(stderr, "Shard %i: worker %i killed by signal %i after %.1f s, restart in %g s\n",
+                        w->shard, (int)pid, WTERMSIG(status), now - w->started, w->delay);
+            else
+                fprintf(stderr, "Shard %i: worker %i failed with status %i after %.1f s, restart in %g s\n",
+                        w->shard, (int)pid, WEXITSTATUS(status), now - w->started, w->delay);
+            w->delay = 2.*w->delay < SUPER_RESTART_MAX ? 2.*w->delay : SUPER_RESTART_MAX;
+            continue;
+        }
+        w->exited = 1;
+        w->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        printf("Shard %i: worker %i exited with status %i\n", w->shard, (int)pid, w->status);
+    }
+}
+
+/* Handle the pending signals */
+static void on_signals (int *stopping)
+{
+    struct signalfd_siginfo si;
+    int ii;
+
+    while (read(gSigFd, &si, sizeof(si)) == sizeof(si))
+    {
+        switch (si.ssi_signo) {
+        case SIGCHLD:
+            reap(*stopping);
+            break;
+        case SIGUSR1:
+            super_report(stdout);
+            break;
+        default:                    // SIGTERM, SIGINT, SIGHUP
+            if (*stopping) break;
+            *stopping = 1;
+            printf("Stopping the workers\n");
+            for (ii = 0; ii < gNWorkers; ii++)
+            {
+                gWorkers[ii].restartAt = 0.;
+                if (gWorkers[ii].pid) kill(gWorkers[ii].pid, SIGTERM);
+            }
+        }
+    }
+}
+
+/*+**************************************************************************
+ *
+ * Function:	super_run
+ *
+ * Description:	Partition the map, start the workers of the shards of this
+ *              host and supervise them until they all exited
+ *
+ * Arg(s) In:	recs      -  Map records
+ *              nrecs     -  Number of records
+ *              adoName   -  ADO of the records without ado=
+ *              partPath  -  Partition file (-J), NULL: none
+ *
+ * Arg(s) Out:	recs, nrecs  -  In the worker: the records of its shard
+ *              exitCode  -  In the supervisor: 0 - all workers exited with 0
+ *                           or were stopped, 1 - otherwise
+ *
+ * Return(s):	In the worker: its shard, in the supervisor: -1
+ *
+ **************************************************************************-*/
+
+int super_run (mapRec recs[], int *nrecs, const char *adoName, const char *partPath, int *exitCode)
+{
+    int *shardOf = malloc(*nrecs*sizeof(int));
+    int nShard[SUPER_MAX_SHARDS];
+    int ii, stopping = 0;
+    double nextReport;
+    sigset_t mask;
+
+    *exitCode = 1;
+    if (!shardOf || partition(recs, *nrecs, adoName, partPath, shardOf)) {
+        free(shardOf);
+        return -1;
+    }
+    memset(nShard, 0, sizeof(nShard));
+    for (ii = 0; ii < *nrecs; ii++) nShard[shardOf[ii]]++;
+    if (gVerb&VERB_INFO)
+        for (ii = 0; ii < gSuperShards; ii++)
+            printf("Shard %i: %i map records%s\n", ii, nShard[ii],
+                   ii < gFirst || ii > gLast ? ", on another host" : "");
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGHUP);
+    sigaddset(&mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &mask, &gOldMask);
+    gSigFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (gSigFd < 0) {
+        perror("signalfd");
+        free(shardOf);
+        return -1;
+    }
+    for (ii = gFirst; ii <= gLast; ii++)
+    {
+        superWorker *w = &gWorkers[gNWorkers++];
+        memset(w, 0, sizeof(*w));
+        w->shard = ii;
+        w->fd = -1;
+        w->delay = SUPER_RESTART_MIN;
+        if (!nShard[ii]) {
+            printf("Shard %i: no map records, not started\n", ii);
+            w->exited = 1;
+            continue;
+        }
+        switch (spawn(w)) {
+        case 0:  return become_worker(recs, nrecs, shardOf, ii);
+        case -1: w->restartAt = sched_now() + w->delay;
+        }
+    }
+
+    nextReport = sched_now() + SUPER_REPORT_PERIOD;
+    for (;;)
+    {
+        struct pollfd pfd[SUPER_MAX_SHARDS + 1];
+        superWorker *pw[SUPER_MAX_SHARDS + 1];
+        double now = sched_now(), next = nextReport;
+        int nfd = 1, live = 0, timeout;
+
+        for (ii = 0; ii < gNWorkers; ii++)
+        {
+            superWorker *w = &gWorkers[ii];
+            if (w->restartAt > 0. && w->restartAt <= now)
+                switch (spawn(w)) {
+                case 0:  return become_worker(recs, nrecs, shardOf, w->shard);
+                case -1: w->restartAt = now + w->delay;
+                }
+            if (w->restartAt > 0. && w->restartAt < next) next = w->restartAt;
+            if (w->fd >= 0) {
+                pfd[nfd].fd = w->fd;
+                pfd[nfd].events = POLLIN;
+                pw[nfd++] = w;
+            }
+            live += w->pid != 0 || w->restartAt > 0.;
+        }
+        if (!live) break;
+        pfd[0].fd = gSigFd;
+        pfd[0].events = POLLIN;
+        timeout = next > now ? (int)((next - now)*1000.) + 1 : 0;
+        if (poll(pfd, nfd, timeout) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        for (ii = 1; ii < nfd; ii++)
+            if (pfd[ii].revents) read_stats(pw[ii]);
+        if (pfd[0].revents) on_signals(&stopping);
+        if (sched_now() >= nextReport)
+        {
+            if (gVerb&VERB_INFO) super_report(stdout);
+            nextReport += SUPER_REPORT_PERIOD;
+        }
+    }
+    super_report(stdout);
+    *exitCode = 0;
+    for (ii = 0; ii < gNWorkers && !stopping; ii++)
+        if (gWorkers[ii].status) *exitCode = 1;
+    close(gSigFd);
+    free(shardOf);
+    return -1;
+}
+
+//''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Worker
+
+static void stats_timer (void *arg, int fd)
+{
+    superStats st;
+    int n, cls;
+
+    memset(&st, 0, sizeof(st));
+    st.uptime = sched_now() - gWorkerStart;
+    st.channels = gWorkerNPvs;
+    for (n = 0; n < gWorkerNPvs; n++)   // CA channels without ch_id are pvAccess channels
+        st.connected += gWorkerPvs[n].ch_id ? ca_state(gWorkerPvs[n].ch_id) == cs_conn
+                                            : pva_connected(&gWorkerPvs[n]);
+    for (cls = 0; cls < SCHED_NCLASS; cls++)
+    {
+        st.events += gSchedStats[cls].enqueued;
+        st.written += gSchedStats[cls].written;
+        st.dropped += gSchedStats[cls].dropped;
+        st.queued += gSchedStats[cls].queued;
+    }
+    if (write(gStatsFd, &st, sizeof(st)) < 0 && errno != EAGAIN) {
+        reactor_remove_timer(fd);       // supervisor gone
+        close(gStatsFd);
+        gStatsFd = -1;
+    }
+}
+
+// super_worker_start - send the counters of the worker to the supervisor
+int super_worker_start (pv *pvs, int nPvs)
+{
+    if (gStatsFd < 0) return 0;
+    gWorkerPvs = pvs;
+    gWorkerNPvs = nPvs;
+    return reactor_add_timer(SUPER_STATS_PERIOD, SUPER_STATS_PERIOD, stats_timer, NULL) < 0;
+}
@@ -0,0 +1,47 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Supervisor mode of the epics to ado bridge (-j and -J options)
+ *
+ * One large map is split into shards, each bridged by its own worker
+ * process. The partition key of a map record is its ADO (ado= or the ADO of
+ * the command line) or its IOC, taken as the PV name up to the first ':'.
+ * The records of one PV and of one write group always share a shard. The
+ * keys are spread by their number of records: the largest first, onto the
+ * least loaded shard.
+ *   -j <n>[:<first>[-<last>]][,ado|ioc]
+ *                 n shards, this host runs the shards first..last (default
+ *                 all), partitioned by ADO (default) or IOC
+ *   -J <file>     partition file, one line "<key> <shard>" per key, shared
+ *                 by the hosts running the shards of one map: written from
+ *                 the computed partition if it does not exist, followed
+ *                 otherwise. Keys missing in it go to the shard of their hash
+ * The supervisor forks the workers after reading the map, before Channel
+ * Access is started. A worker killed by a signal or exiting with a non-zero
+ * status is restarted unless the supervisor is stopping, the other shards
+ * are not affected; the delay grows from SUPER_RESTART_MIN to
+ * SUPER_RESTART_MAX while it keeps failing. A worker which exits with
+ * status 0 is done (end of a soak test) and is not restarted. The workers send
+ * their counters every SUPER_STATS_PERIOD; the supervisor prints the shards
+ * and their totals every SUPER_REPORT_PERIOD with -v1, on SIGUSR1 and at
+ * the end. SIGTERM and SIGINT stop the workers and the supervisor.
+ * The -C, -W and -P names of a worker get the suffix .<shard>.
+ */
+
+#ifndef INCLsuperh
+#define INCLsuperh
+
+#define SUPER_MAX_SHARDS 64         /* Max number of shards (-j) */
+#define SUPER_RESTART_MIN 1.        /* Delay of the first restart after a crash, s */
+#define SUPER_RESTART_MAX 60.       /* Max delay of the restarts, s */
+#define SUPER_STABLE 60.            /* Uptime after which the restart delay is reset, s */
+#define SUPER_STATS_PERIOD 1.       /* Period of the counters sent by the workers, s */
+#define SUPER_REPORT_PERIOD 10.     /* Period of the supervisor printout (-v1), s */
+
+extern int gSuperShards;            /* Number of shards, 0: no supervisor (-j option) */
+
+extern int   super_parse (const char *spec);
+extern int   super_run (mapRec recs[], int *nrecs, const char *adoName, const char *partPath,
+                        int *exitCode);
+extern char *super_path (const char *path, int shard);
+extern int   super_worker_start (pv *pvs, int nPvs);
+
+#endif /* ifndef INCLsuperh */
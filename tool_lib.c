@@ -53,6 +53,7 @@ char timeFormatStr[30] = "%Y-%m-%d %H:%M:%S.%06f"; /* Time format string */
 char fieldSeparator = ' ';          /* OFS default is whitespace */
 
 int enumAsNr = 0;        /* used for -n option - get DBF_ENUM as number */
+int floatAsString = 0;   /* used for -s option - floating point as string with server precision */
 int charArrAsStr = 0;    /* used for -S option - treat char array as (long) string */
 double caTimeout = 1.0;  /* wait time default (see -w option) */
 capri caPriority = DEFAULT_CA_PRIORITY;  /* CA Priority */
@@ -191,6 +192,39 @@ char *val2str (const void *v, unsigned type, int index)
 }
 
 
+
+/*+**************************************************************************
+ *
+ * Function:	val2double
+ *
+ * Description:	Convert value to double, without going through a string
+ *              (strings are parsed, enums give the index)
+ *
+ * Arg(s) In:	v      -  Pointer to dbr_... structure
+ *              type   -  Numeric dbr type
+ *              index  -  Index of element to convert (for arrays)
+ *
+ * Return(s):	Value of the element
+ *
+ **************************************************************************-*/
+
+double val2double (const void *v, unsigned type, int index)
+{
+    const void *val_ptr = dbr_value_ptr(v, type);
+
+    switch (type % (LAST_TYPE+1)) {
+    case DBR_STRING: return atof(((dbr_string_t*) val_ptr)[index]);
+    case DBR_FLOAT:  return ((dbr_float_t*) val_ptr)[index];
+    case DBR_DOUBLE: return ((dbr_double_t*) val_ptr)[index];
+    case DBR_CHAR:   return ((dbr_char_t*) val_ptr)[index];
+    case DBR_INT:    return ((dbr_int_t*) val_ptr)[index];
+    case DBR_LONG:   return ((dbr_long_t*) val_ptr)[index];
+    case DBR_ENUM:   return ((dbr_enum_t*) val_ptr)[index];
+    }
+    return 0.;
+}
+
+
 
 /*+**************************************************************************
  *
@@ -479,7 +513,7 @@ char *dbr2str (const void *value, unsigned type)
     } else {                                                            \
         if (reqElems || pv->nElems > 1) printf("%c%lu", fieldSeparator, pv->nElems); \
         for (i=0; i<pv->nElems; ++i) {                                \
-            printf(" (&RA)Changed to: %c%s", fieldSeparator, val2str(value, TYPE_ENUM, i)); \
+            printf("%c%s", fieldSeparator, val2str(value, TYPE_ENUM, i)); \
         }                                                               \
     }                                                                   \
                              /* Print Status, Severity - if not NO_ALARM */ \
@@ -589,7 +623,7 @@ int create_pvs (pv* pvs, int nPvs, caCh *pCB)
         result = ca_create_channel (pvs[n].name,
                                     pCB,
                                     &pvs[n],
-                                    caPriority,
+                                    pvs[n].priority ? pvs[n].priority : caPriority,
                                     &pvs[n].ch_id);
         if (result != ECA_NORMAL) {
             fprintf(stderr, "CA error %s occurred while trying "
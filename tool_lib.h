@@ -15,6 +15,8 @@
  *  Modification History
  *  2009/03/31 Larry Hoff (BNL)
  *     Added field separators
+ *  2026/10/19
+ *     pv structure: hot fields in the first cache line, aligned
  *
  */
 
@@ -63,22 +65,41 @@ typedef enum { absolute, relative, incremental, incrementalByChan } TimeT;
 /* Output formats for integer data types */
 typedef enum { dec, bin, oct, hex } IntFormatT;
 
-/* Structure representing one PV (= channel) */
+struct pvMeta;              /* Channel metadata cache, see pv_meta.h */
+
+#define PV_CACHE_LINE 64       /* Alignment of the per-channel state */
+#ifdef __GNUC__
+#  define PV_ALIGNED __attribute__((aligned(PV_CACHE_LINE)))
+#else
+#  define PV_ALIGNED
+#endif
+
+/* Structure representing one PV (= channel).
+ * The fields used with every update come first and share the first cache
+ * line; the connection and print state follow. Arrays of pv are allocated
+ * PV_CACHE_LINE aligned, so a channel never shares a line with another. */
 typedef struct 
 {
-    char* name;
-    chid  ch_id;
-    long  dbfType;
+                                /* hot: every update */
+    void* value;
     long  dbrType;
     unsigned long nElems;       // True length of data in value
-    unsigned long reqElems;     // Requested length of data
     int status;
-    void* value;
+    char onceConnected;
+    char fullArray;             // request the full length also for dynamic arrays
+    struct pvMeta *meta;        // metadata from DBR_CTRL, NULL until received
+    char* name;
+    unsigned long reqElems;     // Requested length of data
+                                /* cold: connection, subscription, printing */
+    chid  ch_id;
+    evid  ev_id;                // CA subscription
+    capri priority;             // CA priority of the channel, 0: use caPriority
+    long  dbfType;
+    unsigned long eventMask;    // CA event mask of the subscription
     epicsTimeStamp tsPreviousC;
     epicsTimeStamp tsPreviousS;
     char firstStampPrinted;
-    char onceConnected;
-} pv;
+} PV_ALIGNED pv;
 
 
 extern TimeT tsType;        /* Timestamp type flag (-t option) */
@@ -87,6 +108,7 @@ extern int tsSrcClient;     /* Timestamp source flag (-t option) */
 extern IntFormatT outTypeI; /* Flag used for -0.. output format option */
 extern IntFormatT outTypeF; /* Flag used for -l.. output format option */
 extern int enumAsNr;        /* Used for -n option (get DBF_ENUM as number) */
+extern int floatAsString;   /* Used for -s option (floating point as string, server precision) */
 extern int charArrAsStr;    /* used for -S option - treat char array as (long) string */
 extern double caTimeout;    /* Wait time default (see -w option) */
 extern char dblFormatStr[]; /* Format string to print doubles (see -e -f option) */
@@ -94,6 +116,7 @@ extern char fieldSeparator; /* Output field separator */
 extern capri caPriority;    /* CA priority */
 
 extern char *val2str (const void *v, unsigned type, int index);
+extern double val2double (const void *v, unsigned type, int index);
 extern char *dbr2str (const void *value, unsigned type);
 extern void print_time_val_sts (pv *pv, unsigned long reqElems);
 extern int  create_pvs (pv *pvs, int nPvs, caCh *pCB );
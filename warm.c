@@ -0,0 +1,285 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Warm restart cache of the epics to ado bridge
+ *
+ * version v01 2026-10-19. mmap'ed table of value hashes, first updates skipped.
+ * version v02 2026-10-19. ADO name of the record in the key, warm_hash shared.
+ * version v03 2026-10-19. Hash recorded after the Set succeeded, entries matched by a hash table.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <epicsTime.h>
+
+#include "epics2ado.h"
+#include "warm.h"
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME  1099511628211ULL
+
+static warmHeader *gWarm = NULL;    // the mapped file
+static warmEntry *gEntries = NULL;
+static size_t gWarmSize = 0;
+static char *gFlags = NULL;         // per record, WARM_CHECKED and WARM_FAILED
+static int gNRecs = 0;
+static unsigned long gSkipped = 0, gRecorded = 0, gFailed = 0;
+
+#define WARM_CHECKED 1              /* first update of the record seen */
+#define WARM_FAILED  2              /* a write of the pending update failed */
+
+static uint64_t hash_bytes (uint64_t h, const void *p, size_t len)
+{
+    const unsigned char *c = p;
+    size_t ii;
+    for (ii = 0; ii < len; ii++) h = (h ^ c[ii])*FNV_PRIME;
+    return h;
+}
+
+/* Arrays are hashed a word at a time */
+static uint64_t hash_doubles (uint64_t h, const double *v, unsigned long n)
+{
+    unsigned long ii;
+    uint64_t w;
+    for (ii = 0; ii < n; ii++) {
+        memcpy(&w, &v[ii], sizeof(w));
+        h = (h ^ w)*FNV_PRIME;
+        h ^= h >> 29;
+    }
+    return h;
+}
+
+static uint64_t record_key (const mapRec *rec)
+{
+    uint64_t h = hash_bytes(FNV_OFFSET, rec->pvName, strlen(rec->pvName) + 1);
+    h = hash_bytes(h, rec->param, strlen(rec->param));
+    return rec->ado ? hash_bytes(h, rec->ado, strlen(rec->ado) + 1) : h;
+}
+
+// warm_hash - hash of the values of the writes, never 0
+uint64_t warm_hash (int n, const adoItem items[])
+{
+    uint64_t h = FNV_OFFSET;
+    int ii;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        const adoItem *it = &items[ii];
+        h = hash_bytes(h, &it->type, sizeof(it->type));
+        if (it->count > 1)                   h = hash_doubles(h, it->vec, it->count);
+        else if (it->type == adoTypeString) h = hash_bytes(h, it->str, strlen(it->str) + 1);
+        else                                 h = hash_doubles(h, &it->num, 1);
+    }
+    return h ? h : 1;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	warm_open
+ *
+ * Description:	Map the cache file, create it or fit it to the map
+ *
+ * Arg(s) In:	path   -  File name of the cache
+ *              map    -  Map records, entry n of the table is for map[n]
+ *              nRecs  -  Number of map records
+ *
+ * Return(s):	0 - success, 1 - error
+ *
+ **************************************************************************-*/
+
+/* Open addressing table of the previous entries, slot n holds index + 1, 0: empty */
+static int *old_table (const warmEntry old[], int nOld, size_t *mask)
+{
+    size_t size = 16, slot;
+    int *table, ii;
+
+    while (size < 2*(size_t)nOld) size <<= 1;
+    table = calloc(size, sizeof(int));
+    if (!table) return NULL;
+    *mask = size - 1;
+    for (ii = 0; ii < nOld; ii++)
+    {
+        for (slot = old[ii].key & *mask; table[slot]; slot = (slot + 1) & *mask);
+        table[slot] = ii + 1;
+    }
+    return table;
+}
+
+int warm_open (const char *path, const mapRec map[], int nRecs)
+{
+    size_t size = sizeof(warmHeader) + nRecs*sizeof(warmEntry), mask = 0, slot;
+    warmEntry *old = NULL;
+    int nOld = 0, fd, ii, *table = NULL, matched = 0;
+    struct stat st;
+
+    fd = open(path, O_RDWR|O_CREAT|O_CLOEXEC, 0644);
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+    if ((size_t)st.st_size >= sizeof(warmHeader))   /* keep the entries of the previous run */
+    {
+        warmHeader h;
+        if (pread(fd, &h, sizeof(h), 0) == sizeof(h) && h.magic == WARM_MAGIC
+            && h.version == WARM_VERSION && h.entrySize == sizeof(warmEntry)
+            && (size_t)st.st_size >= sizeof(h) + h.nEntries*sizeof(warmEntry))
+        {
+            old = malloc(h.nEntries*sizeof(warmEntry) + 1);
+            if (old && pread(fd, old, h.nEntries*sizeof(warmEntry), sizeof(h))
+                       == (ssize_t)(h.nEntries*sizeof(warmEntry)))
+                nOld = h.nEntries;
+        }
+    }
+    if (ftruncate(fd, 0) < 0 || ftruncate(fd, size) < 0) {
+        perror(path);
+        free(old);
+        close(fd);
+        return 1;
+    }
+    gWarm = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (gWarm == MAP_FAILED) {
+        perror("mmap");
+        gWarm = NULL;
+        free(old);
+        return 1;
+    }
+    gWarmSize = size;
+    gEntries = (warmEntry *)(gWarm + 1);
+    if (nOld) table = old_table(old, nOld, &mask);
+    for (ii = 0; ii < nRecs; ii++)      /* the records are matched by name */
+    {
+        uint64_t key = record_key(&map[ii]);
+        gEntries[ii].key = key;
+        if (!table) continue;
+        for (slot = key & mask; table[slot]; slot = (slot + 1) & mask)
+        {
+            warmEntry *o = &old[table[slot] - 1];
+            if (o->key == key) {
+                gEntries[ii] = *o;
+                o->key = 0;             /* taken by this record */
+                if (gEntries[ii].hash) matched++;
+                break;
+            }
+        }
+    }
+    free(table);
+    free(old);
+    gWarm->magic = WARM_MAGIC;
+    gWarm->version = WARM_VERSION;
+    gWarm->nEntries = nRecs;
+    gWarm->entrySize = sizeof(warmEntry);
+    gFlags = calloc(nRecs, 1);
+    gNRecs = nRecs;
+    if (gVerb&VERB_INFO) printf("Warm restart cache %s: %i of %i values known\n", path, matched, nRecs);
+    return gFlags == NULL;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	warm_skip
+ *
+ * Description:	Check the first update of the record against the cache and
+ *              mark the writes of an update to be written: the entry is
+ *              cleared until warm_written() sees its last write succeed
+ *
+ * Arg(s) In:	index  -  Map record
+ *              stamp  -  Server timestamp of the update
+ *              n      -  Number of writes of the update
+ *
+ * Arg(s) In/Out: items - The writes, their row and hash are set
+ *
+ * Return(s):	1 - skip the update, ADO holds the value; 0 - write it
+ *
+ **************************************************************************-*/
+
+int warm_skip (int index, const epicsTimeStamp *stamp, int n, adoItem items[])
+{
+    warmEntry *e;
+    uint64_t h;
+    int ii;
+
+    for (ii = 0; ii < n; ii++) {
+        items[ii].row = index;
+        items[ii].hash = 0;
+    }
+    if (!gWarm) return 0;
+    e = &gEntries[index];
+    h = warm_hash(n, items);
+    if (!(gFlags[index] & WARM_CHECKED)) {
+        gFlags[index] |= WARM_CHECKED;
+        if (e->hash == h) {
+            gSkipped++;
+            if (gVerb&VERB_DETAILED) printf("Warm restart: value of record %i unchanged, not written\n", index);
+            return 1;
+        }
+    }
+    e->hash = 0;                        /* ADO may hold either value until the Set returns */
+    e->secPastEpoch = stamp->secPastEpoch;
+    e->nsec = stamp->nsec;
+    items[n - 1].hash = h;
+    return 0;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	warm_written
+ *
+ * Description:	Record the value hashes of the updates whose writes
+ *              succeeded, called by the setters' callers after each Set.
+ *              An item failed if its type cache was reset; if the Set
+ *              reported failures, the items without a type cache are
+ *              taken as failed too.
+ *
+ * Arg(s) In:	n       -  Number of writes of the Set
+ *              items   -  The writes, in the order of warm_skip
+ *              failed  -  Number of failed writes reported by the setter
+ *
+ **************************************************************************-*/
+
+void warm_written (int n, const adoItem items[], int failed)
+{
+    int ii;
+
+    if (!gWarm) return;
+    for (ii = 0; ii < n; ii++)
+    {
+        const adoItem *it = &items[ii];
+        int ok = !failed || (it->cachedType && *it->cachedType != adoTypeUnknown);
+        if (it->row < 0 || it->row >= gNRecs) continue;
+        if (!ok) gFlags[it->row] |= WARM_FAILED;
+        if (!it->hash) continue;        /* not the last write of the update */
+        if (gFlags[it->row] & WARM_FAILED) gFailed++;
+        else {
+            gEntries[it->row].hash = it->hash;
+            gRecorded++;
+        }
+        gFlags[it->row] &= ~WARM_FAILED;
+    }
+}
+
+// warm_invalidate - forget the value written by this run, e.g. after the write failed
+void warm_invalidate (int index)
+{
+    if (gWarm && (gFlags[index] & WARM_CHECKED)) gEntries[index].hash = 0;
+}
+
+void warm_report (FILE *stream)
+{
+    if (gWarm) fprintf(stream, "warm restart: records %i, skipped %lu, recorded %lu, failed %lu\n",
+                       gNRecs, gSkipped, gRecorded, gFailed);
+}
+
+void warm_close (void)
+{
+    if (!gWarm) return;
+    msync(gWarm, gWarmSize, MS_SYNC);
+    munmap(gWarm, gWarmSize);
+    gWarm = NULL;
+    free(gFlags);
+    gFlags = NULL;
+}
@@ -0,0 +1,50 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Warm restart cache of the epics to ado bridge (-W option)
+ *
+ * A small file, mmap'ed shared, holds per map record a hash of the last
+ * value written to ADO and its server timestamp. The entry is cleared when
+ * an update is queued and the hash is recorded only when the Set of its
+ * last write returned without failure, so after a crash the table holds no
+ * value ADO may not have received. After a restart the first
+ * update of a channel is not written if its value hash matches the table:
+ * ADO already holds that value, the restart causes no write storm.
+ * The records are identified by a hash of the PV and parameter names, the
+ * entries of the records which are not in the map anymore are dropped;
+ * the previous entries are looked up in a hash table of their keys.
+ * An entry stays invalid when a write of the update failed.
+ */
+
+#ifndef INCLwarmh
+#define INCLwarmh
+
+#include <stdint.h>
+
+#define WARM_MAGIC 0x4532414d       /* "MA2E" */
+#define WARM_VERSION 1
+
+/* File header, followed by one warmEntry per map record */
+typedef struct warmHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nEntries;
+    uint32_t entrySize;
+} warmHeader;
+
+typedef struct warmEntry
+{
+    uint64_t key;                   // hash of the PV, parameter and ado= names
+    uint64_t hash;                  // hash of the last forwarded value, 0: none
+    uint32_t secPastEpoch;          // server timestamp of the value
+    uint32_t nsec;
+} warmEntry;
+
+extern int  warm_open (const char *path, const mapRec map[], int nRecs);
+extern int  warm_skip (int index, const epicsTimeStamp *stamp, int n, adoItem items[]);
+extern void warm_written (int n, const adoItem items[], int failed);
+extern void warm_invalidate (int index);
+extern void warm_report (FILE *stream);
+extern void warm_close (void);
+extern uint64_t warm_hash (int n, const adoItem items[]);
+
+#endif /* ifndef INCLwarmh */
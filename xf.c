@@ -0,0 +1,622 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Value transforms of the epics to ado bridge
+ *
+ * version v01 2026-10-19. Expression compiler, bytecode, affine kernels.
+ * version v02 2026-10-19. Bounds folded in the order applied, saturating integer conversion,
+ *                         shift counts outside 0..63, bytecode entry points for the checks.
+ * version v03 2026-10-19. min and max pass a NaN, as the clamp kernel does.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <limits.h>
+
+#include <cadef.h>
+
+#include "xf.h"
+
+typedef enum
+{
+    opX, opConst, opNeg,
+    opAdd, opSub, opMul, opDiv, opMod, opAnd, opOr, opShl, opShr,
+    opAbs, opMin, opMax, opClamp, opInt, opRound, opSqrt, opExp, opLog
+} XfOpT;
+
+/* Number of operands of each opcode */
+static const int gArity[] = {0, 0, 1,  2, 2, 2, 2, 2, 2, 2, 2, 2,  1, 2, 2, 3, 1, 1, 1, 1, 1};
+
+static const struct { const char *name; XfOpT op; } gFuncs[] = {
+    {"abs", opAbs}, {"min", opMin}, {"max", opMax}, {"clamp", opClamp},
+    {"int", opInt}, {"round", opRound}, {"sqrt", opSqrt}, {"exp", opExp},
+    {"log", opLog}, {NULL, opX}
+};
+
+typedef struct xfIns
+{
+    XfOpT  op;
+    double c;                       // constant of opConst
+} xfIns;
+
+/* Specialized form: cast(clamp(a*x+b; lo; hi)) */
+typedef enum { castNone, castInt, castRound } XfCastT;
+
+struct xfProg
+{
+    int    n;                       // number of instructions
+    xfIns  code[XF_MAX_CODE];
+    int    affine;                  // the program has the specialized form
+    double a, b, lo, hi;
+    int    clamp;
+    XfCastT cast;
+    char   text[80];                // description for printing
+};
+
+/* Compiler state */
+typedef struct xfParser
+{
+    const char *p;
+    const char *err;
+    xfProg *prog;
+} xfParser;
+
+/* Operand of the bit operators: truncated, saturated to 64 bit, NaN as 0 */
+static long long i64 (double v)
+{
+    if (v != v) return 0;
+    if (v >= 9223372036854775807.) return LLONG_MAX;
+    if (v <= -9223372036854775808.) return LLONG_MIN;
+    return (long long)v;
+}
+
+/* Shift by n bits, 0 (<<) or the sign (>>) when n is outside 0..63 */
+static double shift (double a, double n, int left)
+{
+    long long v = i64(a), k = i64(n);
+    if (k < 0 || k > 63) return left || v >= 0 ? 0. : -1.;
+    return left ? (double)(long long)((unsigned long long)v << k) : (double)(v >> k);
+}
+
+static double round_half (double v)
+{
+    return trunc(v < 0. ? v - 0.5 : v + 0.5);
+}
+
+/* One operation on scalars, used for the evaluation and constant folding */
+static double op_eval (XfOpT op, const double *a)
+{
+    switch (op) {
+    case opNeg:   return -a[0];
+    case opAdd:   return a[0] + a[1];
+    case opSub:   return a[0] - a[1];
+    case opMul:   return a[0] * a[1];
+    case opDiv:   return a[0] / a[1];
+    case opMod:   return fmod(a[0], a[1]);
+    case opAnd:   return (double)(i64(a[0]) & i64(a[1]));
+    case opOr:    return (double)(i64(a[0]) | i64(a[1]));
+    case opShl:   return shift(a[0], a[1], 1);
+    case opShr:   return shift(a[0], a[1], 0);
+    case opAbs:   return fabs(a[0]);
+    case opMin:   return a[0] < a[1] || a[0] != a[0] ? a[0] : a[1];   /* NaN if either is */
+    case opMax:   return a[0] > a[1] || a[0] != a[0] ? a[0] : a[1];
+    case opClamp: return a[0] < a[1] ? a[1] : a[0] > a[2] ? a[2] : a[0];
+    case opInt:   return trunc(a[0]);
+    case opRound: return round_half(a[0]);
+    case opSqrt:  return sqrt(a[0]);
+    case opExp:   return exp(a[0]);
+    case opLog:   return log(a[0]);
+    default:      return 0.;
+    }
+}
+
+/* Append the instruction, fold it if all its operands are constants */
+static void emit (xfParser *ps, XfOpT op, double c)
+{
+    xfProg *prog = ps->prog;
+    int nArg = gArity[op], ii;
+
+    if (op != opX && op != opConst && prog->n >= nArg)
+    {
+        double args[3];
+        for (ii = 0; ii < nArg; ii++)
+            if (prog->code[prog->n - nArg + ii].op != opConst) break;
+        if (ii == nArg) {
+            for (ii = 0; ii < nArg; ii++) args[ii] = prog->code[prog->n - nArg + ii].c;
+            prog->n -= nArg;
+            c = op_eval(op, args);
+            op = opConst;
+        }
+    }
+    if (prog->n >= XF_MAX_CODE) {
+        ps->err = "expression too long";
+        return;
+    }
+    prog->code[prog->n].op = op;
+    prog->code[prog->n].c = c;
+    prog->n++;
+}
+
+static void parse_or (xfParser *ps);
+
+static void skip_blanks (xfParser *ps)
+{
+    while (isspace((unsigned char)*ps->p)) ps->p++;
+}
+
+static void parse_primary (xfParser *ps)
+{
+    skip_blanks(ps);
+    if (*ps->p == '(') {
+        ps->p++;
+        parse_or(ps);
+        skip_blanks(ps);
+        if (*ps->p != ')') { ps->err = "')' expected"; return; }
+        ps->p++;
+    }
+    else if (isdigit((unsigned char)*ps->p) || *ps->p == '.') {
+        char *end;
+        double c = strtod(ps->p, &end);
+        if (end == ps->p) { ps->err = "invalid number"; return; }
+        ps->p = end;
+        emit(ps, opConst, c);
+    }
+    else if (isalpha((unsigned char)*ps->p)) {
+        const char *name = ps->p;
+        size_t len;
+        int ii, arg;
+        while (isalnum((unsigned char)*ps->p)) ps->p++;
+        len = ps->p - name;
+        if (len == 1 && name[0] == 'x') {
+            emit(ps, opX, 0.);
+            return;
+        }
+        for (ii = 0; gFuncs[ii].name; ii++)
+            if (strlen(gFuncs[ii].name) == len && strncmp(gFuncs[ii].name, name, len) == 0) break;
+        if (!gFuncs[ii].name) { ps->err = "unknown name"; return; }
+        skip_blanks(ps);
+        if (*ps->p != '(') { ps->err = "'(' expected"; return; }
+        ps->p++;
+        for (arg = 0; arg < gArity[gFuncs[ii].op] && !ps->err; arg++) {
+            if (arg > 0) {
+                skip_blanks(ps);
+                if (*ps->p != ';') { ps->err = "';' expected"; return; }
+                ps->p++;
+            }
+            parse_or(ps);
+        }
+        skip_blanks(ps);
+        if (*ps->p != ')') { ps->err = "')' expected"; return; }
+        ps->p++;
+        emit(ps, gFuncs[ii].op, 0.);
+    }
+    else ps->err = "operand expected";
+}
+
+static void parse_unary (xfParser *ps)
+{
+    skip_blanks(ps);
+    if (*ps->p == '-') {
+        ps->p++;
+        parse_unary(ps);
+        emit(ps, opNeg, 0.);
+    }
+    else parse_primary(ps);
+}
+
+static void parse_mul (xfParser *ps)
+{
+    parse_unary(ps);
+    while (!ps->err) {
+        XfOpT op;
+        skip_blanks(ps);
+        if      (*ps->p == '*') op = opMul;
+        else if (*ps->p == '/') op = opDiv;
+        else if (*ps->p == '%') op = opMod;
+        else break;
+        ps->p++;
+        parse_unary(ps);
+        emit(ps, op, 0.);
+    }
+}
+
+static void parse_add (xfParser *ps)
+{
+    parse_mul(ps);
+    while (!ps->err) {
+        XfOpT op;
+        skip_blanks(ps);
+        if      (*ps->p == '+') op = opAdd;
+        else if (*ps->p == '-') op = opSub;
+        else break;
+        ps->p++;
+        parse_mul(ps);
+        emit(ps, op, 0.);
+    }
+}
+
+static void parse_shift (xfParser *ps)
+{
+    parse_add(ps);
+    while (!ps->err) {
+        XfOpT op;
+        skip_blanks(ps);
+        if      (strncmp(ps->p, "<<", 2) == 0) op = opShl;
+        else if (strncmp(ps->p, ">>", 2) == 0) op = opShr;
+        else break;
+        ps->p += 2;
+        parse_add(ps);
+        emit(ps, op, 0.);
+    }
+}
+
+static void parse_and (xfParser *ps)
+{
+    parse_shift(ps);
+    while (!ps->err) {
+        skip_blanks(ps);
+        if (*ps->p != '&') break;
+        ps->p++;
+        parse_shift(ps);
+        emit(ps, opAnd, 0.);
+    }
+}
+
+static void parse_or (xfParser *ps)
+{
+    parse_and(ps);
+    while (!ps->err) {
+        skip_blanks(ps);
+        if (*ps->p != '|') break;
+        ps->p++;
+        parse_and(ps);
+        emit(ps, opOr, 0.);
+    }
+}
+
+/* Recognize cast(clamp(a*x+b; lo; hi)) by interpreting the program on the
+ * (a,b) pairs of a*x+b; anything else leaves prog->affine 0. The bounds
+ * are folded in the order they are applied: max(c) raises both ends of
+ * [lo,hi] to c, min(c) lowers both, so lo <= hi holds and one clamp is
+ * the whole chain, e.g. max(min(x;5);10) is [10,10]. A NaN passes min,
+ * max and clamp, in the chain as in the clamp kernel. */
+static void specialize (xfProg *prog)
+{
+    double sa[XF_MAX_STACK], sb[XF_MAX_STACK];
+    int sp = 0, ii, jj, nc;
+    int tail = 0;                   /* past a*x+b: only bounds and a cast may follow */
+
+    prog->clamp = 0;
+    prog->cast = castNone;
+    prog->lo = -HUGE_VAL;
+    prog->hi = HUGE_VAL;
+    for (ii = 0; ii < prog->n; ii++)
+    {
+        const xfIns *in = &prog->code[ii];
+        switch (in->op) {
+        case opConst: sa[sp] = 0.; sb[sp] = in->c; sp++; continue;
+        case opX:
+            if (tail) return;
+            sa[sp] = 1.; sb[sp] = 0.; sp++;
+            continue;
+        case opMin: case opMax: case opClamp:
+            nc = gArity[in->op] - 1;
+            if (in->op != opClamp && sa[sp-2] == 0. && sa[sp-1] != 0.) {
+                double t;                           /* min(c;x) = min(x;c) */
+                t = sa[sp-2]; sa[sp-2] = sa[sp-1]; sa[sp-1] = t;
+                t = sb[sp-2]; sb[sp-2] = sb[sp-1]; sb[sp-1] = t;
+            }
+            sp -= nc;
+            for (jj = 0; jj < nc; jj++) if (sa[sp+jj] != 0.) return;
+            if (prog->cast != castNone) return;
+            if (in->op == opClamp && sb[sp] > sb[sp+1]) return;    /* not a clamp to [lo,hi] */
+            if (in->op != opMin)            /* max(c), the lower bound of clamp */
+            {
+                if (sb[sp] > prog->lo) prog->lo = sb[sp];
+                if (sb[sp] > prog->hi) prog->hi = sb[sp];
+            }
+            if (in->op != opMax)            /* min(c), the upper bound of clamp */
+            {
+                double c = sb[sp + (in->op == opClamp)];
+                if (c < prog->lo) prog->lo = c;
+                if (c < prog->hi) prog->hi = c;
+            }
+            prog->clamp = 1;
+            tail = 1;
+            continue;
+        case opInt: case opRound:
+            if (prog->cast != castNone) return;
+            prog->cast = in->op == opInt ? castInt : castRound;
+            tail = 1;
+            continue;
+        default:
+            if (tail) return;
+        }
+        switch (in->op) {           /* a*x+b stays a*x+b */
+        case opNeg: sa[sp-1] = -sa[sp-1]; sb[sp-1] = -sb[sp-1]; break;
+        case opAdd: sp--; sa[sp-1] += sa[sp]; sb[sp-1] += sb[sp]; break;
+        case opSub: sp--; sa[sp-1] -= sa[sp]; sb[sp-1] -= sb[sp]; break;
+        case opMul:
+            sp--;
+            if (sa[sp] == 0.)        { sa[sp-1] *= sb[sp]; sb[sp-1] *= sb[sp]; }
+            else if (sa[sp-1] == 0.) { sa[sp-1] = sa[sp]*sb[sp-1]; sb[sp-1] *= sb[sp]; }
+            else return;
+            break;
+        case opDiv:
+            sp--;
+            if (sa[sp] != 0. || sb[sp] == 0.) return;
+            sa[sp-1] /= sb[sp]; sb[sp-1] /= sb[sp];
+            break;
+        default: return;
+        }
+    }
+    if (sp != 1) return;
+    prog->a = sa[0];
+    prog->b = sb[0];
+    prog->affine = 1;
+}
+
+/*+**************************************************************************
+ *
+ * Function:	xf_compile
+ *
+ * Description:	Compile the transform expression
+ *
+ * Arg(s) In:	expr  -  Expression, see xf.h
+ *
+ * Arg(s) Out:	err   -  Reason of the failure
+ *
+ * Return(s):	The program, NULL on error
+ *
+ **************************************************************************-*/
+
+xfProg *xf_compile (const char *expr, const char **err)
+{
+    xfParser ps;
+    int ii, depth = 0, maxDepth = 0;
+
+    ps.p = expr;
+    ps.err = NULL;
+    ps.prog = calloc(1, sizeof(xfProg));
+    if (!ps.prog) { *err = "no memory"; return NULL; }
+    parse_or(&ps);
+    skip_blanks(&ps);
+    if (!ps.err && *ps.p) ps.err = "unexpected character";
+    for (ii = 0; ii < ps.prog->n && !ps.err; ii++) {
+        XfOpT op = ps.prog->code[ii].op;
+        depth += (op == opX || op == opConst) ? 1 : 1 - gArity[op];
+        if (depth > maxDepth) maxDepth = depth;
+    }
+    if (!ps.err && maxDepth > XF_MAX_STACK) ps.err = "expression too deep";
+    if (ps.err) {
+        *err = ps.err;
+        free(ps.prog);
+        return NULL;
+    }
+    specialize(ps.prog);
+    if (ps.prog->affine)
+        snprintf(ps.prog->text, sizeof(ps.prog->text), "%g*x%+g%s%s", ps.prog->a, ps.prog->b,
+                 ps.prog->clamp ? ", clamped" : "",
+                 ps.prog->cast == castInt ? ", int" : ps.prog->cast == castRound ? ", round" : "");
+    else
+        snprintf(ps.prog->text, sizeof(ps.prog->text), "bytecode, %i instructions", ps.prog->n);
+    return ps.prog;
+}
+
+const char *xf_describe (const xfProg *prog)
+{
+    return prog->text;
+}
+
+double xf_eval (const xfProg *prog, double x)
+{
+    if (prog->affine) {
+        double v = prog->a*x + prog->b;
+        if (prog->clamp) v = v < prog->lo ? prog->lo : v > prog->hi ? prog->hi : v;
+        if (prog->cast == castInt) v = trunc(v);
+        else if (prog->cast == castRound) v = round_half(v);
+        return v;
+    }
+    return xf_eval_code(prog, x);
+}
+
+// xf_eval_code - evaluate by the bytecode, also a specialized program (checks)
+double xf_eval_code (const xfProg *prog, double x)
+{
+    double st[XF_MAX_STACK];
+    int sp = 0, ii;
+
+    for (ii = 0; ii < prog->n; ii++)
+    {
+        const xfIns *in = &prog->code[ii];
+        int nArg;
+        switch (in->op) {
+        case opX:     st[sp++] = x; break;
+        case opConst: st[sp++] = in->c; break;
+        default:
+            nArg = gArity[in->op];
+            sp -= nArg;
+            st[sp] = op_eval(in->op, &st[sp]);
+            sp++;
+        }
+    }
+    return st[0];
+}
+
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+// Array kernels: plain C loops, no intrinsics or target specific code, so the
+// bridge builds unchanged on every host of the ADO libraries and vectorizing
+// is left to the compiler. The reduction lanes (reduce.c), the shared-memory
+// conversions (shm_pub.c) and the delta comparison (delta.c) follow this
+// choice. Measured with gcc 12.2 -fopt-info-vec on x86-64:
+//   -O2               only the reduction lanes vectorize, these kernels not
+//   -O3 or -O2 -ftree-vectorize
+//                     affine, clamp, the kernel_op loops (versioned for
+//                     aliasing, dst may be src[0]), the DBR conversions and
+//                     the shm_pub conversions vectorize with SSE2
+//   int, round        trunc() needs also -msse4.1 -fno-trapping-math
+//   count_changed     64 bit compares need -msse4.1 or -mavx2
+// hence -O3 in the README (Compilation).
+
+static void kernel_affine (double *restrict v, unsigned long n, double a, double b)
+{
+    unsigned long ii;
+    for (ii = 0; ii < n; ii++) v[ii] = v[ii]*a + b;
+}
+
+static void kernel_clamp (double *restrict v, unsigned long n, double lo, double hi)
+{
+    unsigned long ii;
+    for (ii = 0; ii < n; ii++) {
+        double t = v[ii] < lo ? lo : v[ii];
+        v[ii] = t > hi ? hi : t;
+    }
+}
+
+static void kernel_int (double *restrict v, unsigned long n)
+{
+    unsigned long ii;
+    for (ii = 0; ii < n; ii++) v[ii] = trunc(v[ii]);
+}
+
+static void kernel_round (double *restrict v, unsigned long n)
+{
+    unsigned long ii;
+    for (ii = 0; ii < n; ii++) v[ii] = trunc(v[ii] + (v[ii] < 0. ? -0.5 : 0.5));
+}
+
+/* One instruction over a block: dst = op(src...), dst is src[0] */
+static void kernel_op (XfOpT op, double *dst, double *const *src, int n)
+{
+    const double *a = src[0], *b = src[1], *c = src[2];
+    int ii;
+    switch (op) {
+    case opNeg: for (ii = 0; ii < n; ii++) dst[ii] = -a[ii]; break;
+    case opAdd: for (ii = 0; ii < n; ii++) dst[ii] = a[ii] + b[ii]; break;
+    case opSub: for (ii = 0; ii < n; ii++) dst[ii] = a[ii] - b[ii]; break;
+    case opMul: for (ii = 0; ii < n; ii++) dst[ii] = a[ii] * b[ii]; break;
+    case opDiv: for (ii = 0; ii < n; ii++) dst[ii] = a[ii] / b[ii]; break;
+    case opMin: for (ii = 0; ii < n; ii++) dst[ii] = a[ii] < b[ii] || a[ii] != a[ii] ? a[ii] : b[ii]; break;
+    case opMax: for (ii = 0; ii < n; ii++) dst[ii] = a[ii] > b[ii] || a[ii] != a[ii] ? a[ii] : b[ii]; break;
+    case opAbs: for (ii = 0; ii < n; ii++) dst[ii] = fabs(a[ii]); break;
+    case opClamp:
+        for (ii = 0; ii < n; ii++) dst[ii] = a[ii] < b[ii] ? b[ii] : a[ii] > c[ii] ? c[ii] : a[ii];
+        break;
+    default:
+        for (ii = 0; ii < n; ii++) {
+            double args[3];
+            args[0] = a[ii];
+            if (b) args[1] = b[ii];
+            if (c) args[2] = c[ii];
+            dst[ii] = op_eval(op, args);
+        }
+    }
+}
+
+/*+**************************************************************************
+ *
+ * Function:	xf_apply
+ *
+ * Description:	Transform the array in place
+ *
+ * Arg(s) In:	prog  -  Compiled transform
+ *              v     -  Values
+ *              n     -  Number of values
+ *
+ **************************************************************************-*/
+
+void xf_apply (const xfProg *prog, double *v, unsigned long n)
+{
+    if (n == 1) {
+        v[0] = xf_eval(prog, v[0]);
+        return;
+    }
+    if (prog->affine) {
+        if (prog->a != 1. || prog->b != 0.) kernel_affine(v, n, prog->a, prog->b);
+        if (prog->clamp) kernel_clamp(v, n, prog->lo, prog->hi);
+        if (prog->cast == castInt) kernel_int(v, n);
+        else if (prog->cast == castRound) kernel_round(v, n);
+        return;
+    }
+    xf_apply_code(prog, v, n);
+}
+
+// xf_apply_code - transform the array by the block interpreter, also a specialized program (checks)
+void xf_apply_code (const xfProg *prog, double *v, unsigned long n)
+{
+    static double st[XF_MAX_STACK][XF_BLOCK];
+    unsigned long base;
+
+    for (base = 0; base < n; base += XF_BLOCK)
+    {
+        int len = n - base < XF_BLOCK ? n - base : XF_BLOCK;
+        int sp = 0, ii, jj;
+        for (ii = 0; ii < prog->n; ii++)
+        {
+            const xfIns *in = &prog->code[ii];
+            double *src[3] = {NULL, NULL, NULL};
+            int nArg;
+            switch (in->op) {
+            case opX:
+                memcpy(st[sp++], v + base, len*sizeof(double));
+                break;
+            case opConst:
+                for (jj = 0; jj < len; jj++) st[sp][jj] = in->c;
+                sp++;
+                break;
+            default:
+                nArg = gArity[in->op];
+                sp -= nArg;
+                for (jj = 0; jj < nArg; jj++) src[jj] = st[sp+jj];
+                kernel_op(in->op, st[sp], src, len);
+                sp++;
+            }
+        }
+        memcpy(v + base, st[0], len*sizeof(double));
+    }
+}
+
+/*+**************************************************************************
+ *
+ * Function:	xf_input
+ *
+ * Description:	Convert the first n elements of the DBR value to doubles
+ *
+ * Arg(s) In:	dbr      -  Pointer to dbr_... structure
+ *              dbrType  -  Numeric dbr type
+ *              n        -  Number of elements
+ *
+ * Return(s):	Pointer to static buffer, valid until the next call,
+ *              NULL if it could not be allocated
+ *
+ **************************************************************************-*/
+
+double *xf_input (const void *dbr, long dbrType, unsigned long n)
+{
+    static double *buf = NULL;
+    static unsigned long size = 0;
+    const void *val = dbr_value_ptr(dbr, dbrType);
+    unsigned long ii;
+
+    if (n > size) {
+        double *p = realloc(buf, n*sizeof(double));
+        if (!p) return NULL;
+        buf = p;
+        size = n;
+    }
+#define XF_CONVERT(T) { const T *restrict s = val; for (ii = 0; ii < n; ii++) buf[ii] = s[ii]; }
+    switch (dbrType % (LAST_TYPE+1)) {
+    case DBR_STRING:
+        for (ii = 0; ii < n; ii++) buf[ii] = atof(((const dbr_string_t *)val)[ii]);
+        break;
+    case DBR_FLOAT:  XF_CONVERT(dbr_float_t); break;
+    case DBR_DOUBLE: XF_CONVERT(dbr_double_t); break;
+    case DBR_CHAR:   XF_CONVERT(dbr_char_t); break;
+    case DBR_SHORT:  XF_CONVERT(dbr_short_t); break;
+    case DBR_LONG:   XF_CONVERT(dbr_long_t); break;
+    case DBR_ENUM:   XF_CONVERT(dbr_enum_t); break;
+    default: memset(buf, 0, n*sizeof(double));
+    }
+#undef XF_CONVERT
+    return buf;
+}
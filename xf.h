@@ -0,0 +1,42 @@
+//'''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''''
+/* Value transforms of the epics to ado bridge (xf=<expr> in the csv map)
+ *
+ * The expression of a map record is compiled once, when the map is loaded,
+ * into a small stack bytecode with the constant subexpressions folded.
+ * Variable: x, the EPICS value (enum: index, string: parsed number).
+ * Operators, by increasing precedence: |  &  << >>  + -  * / %  unary -
+ * Functions: abs(a) min(a;b) max(a;b) clamp(a;lo;hi) int(a) round(a)
+ *            sqrt(a) exp(a) log(a)
+ * The arguments are separated by ';' since the map is comma separated,
+ * the bit operators work on the values truncated and saturated to 64 bit
+ * integers (NaN as 0); shifts by counts outside 0..63 give 0, or -1 for
+ * >> of a negative value. int(a) truncates toward zero.
+ * Example: xf=clamp((x>>4)&255;0;100)  xf=x*0.001+273.15
+ *
+ * Arrays are transformed in blocks. A program of the form
+ *   cast(clamp(a*x+b; lo; hi)), clamp and cast optional,
+ * is recognized at compile time and runs as straight loops (scale/offset,
+ * clamp, cast), vectorized by the compiler at -O3 (see xf.c); other programs are
+ * interpreted one operation at a time over a block of elements.
+ * xf_eval_code() and xf_apply_code() always run the bytecode, the checks
+ * (-T) compare them with the specialized loops.
+ */
+
+#ifndef INCLxfh
+#define INCLxfh
+
+#define XF_MAX_CODE 64              /* Max instructions of a program */
+#define XF_MAX_STACK 16             /* Max evaluation stack depth */
+#define XF_BLOCK 256                /* Elements per block of the array interpreter */
+
+typedef struct xfProg xfProg;
+
+extern xfProg *xf_compile (const char *expr, const char **err);
+extern double  xf_eval (const xfProg *prog, double x);
+extern void    xf_apply (const xfProg *prog, double *v, unsigned long n);
+extern double  xf_eval_code (const xfProg *prog, double x);
+extern void    xf_apply_code (const xfProg *prog, double *v, unsigned long n);
+extern double *xf_input (const void *dbr, long dbrType, unsigned long n);
+extern const char *xf_describe (const xfProg *prog);
+
+#endif /* ifndef INCLxfh */